@@ -0,0 +1,617 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <getopt.h>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <malloc.h>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+
+#include "leet_283_move_zeroes.h"
+#include "me_crossstitch_calc.h"
+#include "me_crossstitch_dp.h"
+#include "me_crossstitch_k.h"
+#include "me_crossstitch_mc.h"
+#include "me_crossstitch_table.h"
+#include "parallel_compaction.h"
+#include "stat_utils.h"
+#include "stream_compaction.h"
+
+/**
+ * Size-scaling benchmarks for the kernels of this tree: move zeroes / stream compaction,
+ * the cross stitch engines and the binomial coefficients of stat_utils.
+ *
+ * Every series is run over growing input sizes. For every size the best time of the
+ * repeats, the throughput, the peak resident memory and its growth over the memory held
+ * before the measurement are reported, and every series
+ * gets a power-law fit time ~ size^exponent, so a kernel that loses its expected
+ * complexity stands out. The results can be written as JSON for regression tracking.
+ */
+
+namespace {
+
+struct BenchOptions {
+    std::uint64_t maxElements = 100000000; ///< The largest compaction buffer, in elements.
+    int maxCrossStitch = 2000; ///< The largest n = m = k for the DP engines.
+    int repeats = 3; ///< The best of this many runs is reported.
+    unsigned threads = 0; ///< Threads for the parallel kernels, 0 means all cores.
+    std::string jsonPath; ///< Where to write the JSON report, if set.
+    std::string filter; ///< Only run the series containing this substring.
+    std::string tablePath = "leet_bench_crossstitch.bin"; ///< Scratch file for the answer table series.
+};
+
+struct Measurement {
+    std::string series;
+    std::uint64_t size = 0; ///< Input size in the units of the series.
+    double seconds = 0.0; ///< Best time of the repeats.
+    double itemsPerSecond = 0.0;
+    double bytesPerSecond = 0.0; ///< 0 if the series doesn't process a buffer.
+    long peakRssKb = 0; ///< Peak resident memory during the measurement.
+    long rssGrowthKb = 0; ///< Growth of the peak over the resident memory before the measurement.
+};
+
+struct Fit {
+    std::string series;
+    double exponent = 0.0; ///< time ~ size^exponent
+    double r2 = 0.0; ///< Coefficient of determination of the log-log fit.
+};
+
+/**
+ * Resets the peak resident memory counter of the process (Linux 4.0+).
+ * If the kernel doesn't allow it, the peak stays the one of the whole run so far.
+ * The heap memory freed by the earlier measurements is returned to the system first,
+ * otherwise it stays resident and is counted into the peak.
+ */
+void ResetPeakRss() {
+    malloc_trim(0);
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+}
+
+/**
+ * A memory field of /proc/self/status in KiB, e.g. "VmRSS:", or -1 if it is not available.
+ */
+long ReadStatusKb(const std::string& field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind(field, 0) == 0) {
+            return std::stol(line.substr(field.size()));
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * The peak resident memory since the last ResetPeakRss(), in KiB.
+ */
+long ReadPeakRssKb() {
+    const long peak = ReadStatusKb("VmHWM:");
+    if (peak >= 0) {
+        return peak;
+    }
+
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * The current resident memory in KiB, 0 if it is not available.
+ */
+long ReadRssKb() {
+    return std::max(0L, ReadStatusKb("VmRSS:"));
+}
+
+/**
+ * Fills the buffer with a reproducible pattern where about zeroPercent of the elements are zero.
+ */
+template <typename T>
+void FillWithZeroes(T* data, const std::size_t size, const int zeroPercent) {
+    for (std::size_t i = 0; i < size; i++) {
+        std::uint64_t z = (i + 1) * 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z ^= z >> 31;
+        data[i] = static_cast<int>(z % 100) < zeroPercent ? T(0) : static_cast<T>(z % 1000 + 1);
+    }
+}
+
+class BenchRunner {
+public:
+    explicit BenchRunner(const BenchOptions& options)
+        : options(options)
+    {}
+
+    bool Enabled(const std::string& series) const {
+        return options.filter.empty() || series.find(options.filter) != std::string::npos;
+    }
+
+    /**
+     * Measures run() for one size. prepare(), if set, is called before every run and is not timed.
+     * Runs shorter than MIN_SAMPLE_SECONDS are repeated within every sample and the sample time
+     * is divided by their count, so the small sizes are not lost in the clock resolution.
+     * The inputs should be allocated for this size only: memory held over from larger sizes
+     * counts into the peak, while the growth column only shows what the measurement adds.
+     */
+    void Measure(
+        const std::string& series,
+        const std::uint64_t size,
+        const std::uint64_t bytes,
+        const std::function<void()>& prepare,
+        const std::function<void()>& run)
+    {
+        ResetPeakRss();
+        const long baselineRssKb = ReadRssKb();
+
+        // The first run calibrates the count and is reported itself if it is long enough
+        double best = std::numeric_limits<double>::infinity();
+        const double first = TimeRuns(prepare, run, 1);
+        std::uint64_t innerRuns = 1;
+        int repeats = options.repeats;
+        if (first >= MIN_SAMPLE_SECONDS) {
+            best = first;
+            repeats--;
+        } else {
+            innerRuns = std::min<std::uint64_t>(MAX_INNER_RUNS, std::ceil(MIN_SAMPLE_SECONDS / std::max(first, 1e-9)));
+        }
+
+        for (int repeat = 0; repeat < repeats; repeat++) {
+            best = std::min(best, TimeRuns(prepare, run, innerRuns) / innerRuns);
+        }
+
+        Measurement measurement;
+        measurement.series = series;
+        measurement.size = size;
+        measurement.seconds = best;
+        measurement.itemsPerSecond = size / best;
+        measurement.bytesPerSecond = bytes / best;
+        measurement.peakRssKb = ReadPeakRssKb();
+        measurement.rssGrowthKb = std::max(0L, measurement.peakRssKb - baselineRssKb);
+        measurements.push_back(measurement);
+
+        std::cout << std::left << std::setw(40) << series
+                  << std::right << std::setw(14) << size
+                  << std::setw(14) << std::setprecision(4) << best * 1e3 << " ms"
+                  << std::setw(12) << std::setprecision(4) << measurement.itemsPerSecond / 1e6 << " M/s";
+        if (bytes > 0) {
+            std::cout << std::setw(10) << std::setprecision(4) << measurement.bytesPerSecond / 1e9 << " GB/s";
+        } else {
+            std::cout << std::setw(15) << "";
+        }
+        std::cout << std::setw(12) << measurement.peakRssKb / 1024 << " MiB"
+                  << std::setw(10) << "+" + std::to_string(measurement.rssGrowthKb / 1024) << " MiB" << std::endl;
+    }
+
+    /**
+     * Least squares fit of log(time) = exponent * log(size) + c for every series.
+     */
+    void FitComplexities() {
+        std::vector<std::string> seriesNames;
+        for (const Measurement& measurement : measurements) {
+            if (std::find(seriesNames.begin(), seriesNames.end(), measurement.series) == seriesNames.end()) {
+                seriesNames.push_back(measurement.series);
+            }
+        }
+
+        std::cout << "\nComplexity fits, time ~ size^exponent:" << std::endl;
+        for (const std::string& series : seriesNames) {
+            std::vector<double> xs;
+            std::vector<double> ys;
+            for (const Measurement& measurement : measurements) {
+                if (measurement.series == series) {
+                    xs.push_back(std::log(static_cast<double>(measurement.size)));
+                    ys.push_back(std::log(measurement.seconds));
+                }
+            }
+
+            if (xs.size() < 2) {
+                continue;
+            }
+
+            const double count = static_cast<double>(xs.size());
+            double meanX = 0.0;
+            double meanY = 0.0;
+            for (std::size_t i = 0; i < xs.size(); i++) {
+                meanX += xs[i] / count;
+                meanY += ys[i] / count;
+            }
+
+            double sxx = 0.0;
+            double sxy = 0.0;
+            double syy = 0.0;
+            for (std::size_t i = 0; i < xs.size(); i++) {
+                sxx += (xs[i] - meanX) * (xs[i] - meanX);
+                sxy += (xs[i] - meanX) * (ys[i] - meanY);
+                syy += (ys[i] - meanY) * (ys[i] - meanY);
+            }
+
+            if (sxx <= 0.0) {
+                continue;
+            }
+
+            Fit fit;
+            fit.series = series;
+            fit.exponent = sxy / sxx;
+            fit.r2 = syy > 0.0 ? sxy * sxy / (sxx * syy) : 1.0;
+            fits.push_back(fit);
+
+            std::cout << std::left << std::setw(40) << series << std::right
+                      << " O(n^" << std::setprecision(3) << fit.exponent << "), R^2 = " << fit.r2 << std::endl;
+        }
+    }
+
+    void WriteJson(const std::string& path) const {
+        std::ofstream output(path);
+        output << std::setprecision(std::numeric_limits<double>::max_digits10);
+        output << "{\n  \"measurements\": [\n";
+        for (std::size_t i = 0; i < measurements.size(); i++) {
+            const Measurement& m = measurements[i];
+            output << "    {\"series\": \"" << m.series << "\", \"size\": " << m.size
+                   << ", \"seconds\": " << m.seconds
+                   << ", \"items_per_second\": " << m.itemsPerSecond
+                   << ", \"bytes_per_second\": " << m.bytesPerSecond
+                   << ", \"peak_rss_kb\": " << m.peakRssKb
+                   << ", \"rss_growth_kb\": " << m.rssGrowthKb << "}"
+                   << (i + 1 < measurements.size() ? "," : "") << "\n";
+        }
+        output << "  ],\n  \"fits\": [\n";
+        for (std::size_t i = 0; i < fits.size(); i++) {
+            output << "    {\"series\": \"" << fits[i].series << "\", \"exponent\": " << fits[i].exponent
+                   << ", \"r2\": " << fits[i].r2 << "}" << (i + 1 < fits.size() ? "," : "") << "\n";
+        }
+        output << "  ]\n}\n";
+
+        if (!output) {
+            throw std::runtime_error("Can't write the JSON report: " + path);
+        }
+    }
+
+private:
+    /**
+     * Total time of count runs. Without prepare() they are timed as a whole,
+     * otherwise every run is timed separately after its prepare().
+     */
+    static double TimeRuns(const std::function<void()>& prepare, const std::function<void()>& run, const std::uint64_t count) {
+        if (!prepare) {
+            const auto start = std::chrono::steady_clock::now();
+            for (std::uint64_t i = 0; i < count; i++) {
+                run();
+            }
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        double total = 0.0;
+        for (std::uint64_t i = 0; i < count; i++) {
+            prepare();
+            const auto start = std::chrono::steady_clock::now();
+            run();
+            total += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        return total;
+    }
+
+    static constexpr double MIN_SAMPLE_SECONDS = 1e-3;
+    static constexpr std::uint64_t MAX_INNER_RUNS = 1 << 20;
+
+    const BenchOptions options;
+    std::vector<Measurement> measurements;
+    std::vector<Fit> fits;
+};
+
+/**
+ * Sizes 10^3, 3*10^3, 10^4, ... up to maxSize.
+ */
+std::vector<std::uint64_t> GeometricSizes(const std::uint64_t minSize, const std::uint64_t maxSize) {
+    std::vector<std::uint64_t> sizes;
+    for (std::uint64_t size = minSize; size <= maxSize; size *= 10) {
+        sizes.push_back(size);
+        if (3 * size <= maxSize) {
+            sizes.push_back(3 * size);
+        }
+    }
+
+    return sizes;
+}
+
+void RunCompactionBenchmarks(BenchRunner& runner, const BenchOptions& options) {
+    using namespace compaction;
+
+    const std::vector<std::uint64_t> sizes = GeometricSizes(1000, options.maxElements);
+
+    auto runSeries = [&](const std::string& series, const std::function<void(std::vector<std::int32_t>&)>& kernel) {
+        if (!runner.Enabled(series)) {
+            return;
+        }
+
+        for (const std::uint64_t size : sizes) {
+            std::vector<std::int32_t> buffer(size);
+            runner.Measure(series, size, size * sizeof(std::int32_t),
+                [&]() { FillWithZeroes(buffer.data(), buffer.size(), 50); },
+                [&]() { kernel(buffer); });
+        }
+    };
+
+    runSeries("leet_283/moveZeroes", [](std::vector<std::int32_t>& data) {
+        Solution_leet_283 solution;
+        solution.moveZeroes(data);
+    });
+
+    const std::pair<Isa, const char*> isas[] = {
+        {Isa::Scalar, "scalar"},
+        {Isa::Avx2, "avx2"},
+        {Isa::Avx512, "avx512"},
+    };
+    for (const auto& [isa, name] : isas) {
+        if (isa != Isa::Scalar && static_cast<int>(DetectIsa()) < static_cast<int>(isa)) {
+            continue;
+        }
+
+        runSeries(std::string("compaction/int32/") + name, [isa = isa](std::vector<std::int32_t>& data) {
+            CompactNotEqual(data.data(), data.size(), 0, isa);
+        });
+    }
+
+    runSeries("compaction/int32/parallel", [&options](std::vector<std::int32_t>& data) {
+        ParallelStableCompact(data, NotEqual<std::int32_t>{0}, options.threads);
+    });
+}
+
+void RunCrossStitchBenchmarks(BenchRunner& runner, const BenchOptions& options) {
+    using namespace crossstitch;
+
+    // The combinatorial engine is limited to n + m + k - 2 <= 40
+    if (runner.Enabled("crossstitch/simple")) {
+        for (int n = 2; n <= 13; n++) {
+            runner.Measure("crossstitch/simple", n, 0, nullptr, [n]() {
+                SimpleCrossStitch cross(n, n, n);
+                cross.Calc();
+            });
+        }
+    }
+
+    std::vector<int> dpSizes;
+    for (int n = 16; n <= options.maxCrossStitch; n *= 2) {
+        dpSizes.push_back(n);
+    }
+
+    if (runner.Enabled("crossstitch/dp")) {
+        for (const int n : dpSizes) {
+            runner.Measure("crossstitch/dp", n, 0, nullptr, [n]() {
+                DpCrossStitch cross(n, n, n);
+                cross.Calc();
+            });
+        }
+    }
+
+    if (runner.Enabled("crossstitch/k3")) {
+        for (const int n : dpSizes) {
+            runner.Measure("crossstitch/k3", n, 0, nullptr, [n]() {
+                CrossStitch<3> cross({n, n, n});
+                cross.Calc();
+            });
+        }
+    }
+
+    // Every trial takes O(n) steps
+    if (runner.Enabled("crossstitch/monte_carlo")) {
+        for (const int n : dpSizes) {
+            runner.Measure("crossstitch/monte_carlo", n, 0, nullptr, [n, &options]() {
+                MonteCarloCrossStitch cross(n, n, n);
+                cross.Calc(10000, 0, options.threads);
+            });
+        }
+    }
+
+    // The generation is O(N^4) for the table of all the triples up to N
+    const int maxTableCount = std::min(128, options.maxCrossStitch);
+    if (runner.Enabled("crossstitch/table_generate")) {
+        for (int maxCount = 16; maxCount <= maxTableCount; maxCount *= 2) {
+            runner.Measure("crossstitch/table_generate", maxCount, 0, nullptr, [maxCount, &options]() {
+                GenerateCrossStitchTable(options.tablePath, maxCount);
+            });
+        }
+    }
+
+    if (runner.Enabled("crossstitch/table_lookup") && maxTableCount > 0) {
+        GenerateCrossStitchTable(options.tablePath, maxTableCount);
+        CrossStitchTable table(options.tablePath);
+        double checksum = 0.0;
+        for (const std::uint64_t queries : GeometricSizes(1000, 10000000)) {
+            runner.Measure("crossstitch/table_lookup", queries, 0, nullptr, [&]() {
+                double result[3];
+                for (std::uint64_t i = 0; i < queries; i++) {
+                    const int n = static_cast<int>(i % maxTableCount) + 1;
+                    const int m = static_cast<int>(i * 7 % maxTableCount) + 1;
+                    const int k = static_cast<int>(i * 13 % maxTableCount) + 1;
+                    table.Lookup(n, m, k, result);
+                    checksum += result[0];
+                }
+            });
+        }
+
+        if (checksum < 0.0) {
+            std::cout << checksum << std::endl;
+        }
+    }
+
+    std::remove(options.tablePath.c_str());
+}
+
+/**
+ * Binomial coefficients for random pairs: the exact values for n <= SMALL_BINOMIAL_MAX_N,
+ * and the logarithms for n <= 10^5, where the exact values overflow.
+ */
+void RunStatUtilsBenchmarks(BenchRunner& runner) {
+    using namespace stat_utils;
+
+    struct Pairs {
+        std::vector<std::uint64_t> n;
+        std::vector<std::uint64_t> k;
+        std::vector<std::uint64_t> result;
+        std::vector<double> logResult;
+    };
+
+    // The log-factorial table grows on demand, so it is grown up front and not timed in the first size
+    constexpr std::uint64_t LOG_MAX_N = 100000;
+    BinomialTable table;
+    table.LogFactorial(LOG_MAX_N);
+    const std::vector<std::uint64_t> sizes = GeometricSizes(1000, 10000000);
+
+    // The pairs are allocated for every size, so the peak memory of a size doesn't include larger ones
+    auto runSeries = [&](const std::string& series, const std::uint64_t maxN, const std::function<void(Pairs&)>& kernel) {
+        if (!runner.Enabled(series)) {
+            return;
+        }
+
+        for (const std::uint64_t size : sizes) {
+            Pairs pairs;
+            pairs.n.resize(size);
+            pairs.k.resize(size);
+            for (std::uint64_t i = 0; i < size; i++) {
+                pairs.n[i] = (i * 0x9e3779b97f4a7c15ULL >> 40) % (maxN + 1);
+                pairs.k[i] = (i * 0xbf58476d1ce4e5b9ULL >> 40) % (pairs.n[i] + 1);
+            }
+
+            if (maxN <= SMALL_BINOMIAL_MAX_N) {
+                pairs.result.resize(size);
+            } else {
+                pairs.logResult.resize(size);
+            }
+
+            runner.Measure(series, size, 0, nullptr, [&]() { kernel(pairs); });
+        }
+    };
+
+    runSeries("stat_utils/CombinationsKN", SMALL_BINOMIAL_MAX_N, [](Pairs& pairs) {
+        for (std::size_t i = 0; i < pairs.n.size(); i++) {
+            pairs.result[i] = CombinationsKN(pairs.n[i], pairs.k[i]);
+        }
+    });
+
+    runSeries("stat_utils/SmallCombinationsKN", SMALL_BINOMIAL_MAX_N, [](Pairs& pairs) {
+        for (std::size_t i = 0; i < pairs.n.size(); i++) {
+            pairs.result[i] = SmallCombinationsKN(pairs.n[i], pairs.k[i]);
+        }
+    });
+
+    runSeries("stat_utils/Combinations", SMALL_BINOMIAL_MAX_N, [&table](Pairs& pairs) {
+        for (std::size_t i = 0; i < pairs.n.size(); i++) {
+            pairs.result[i] = table.Combinations(pairs.n[i], pairs.k[i]);
+        }
+    });
+
+    runSeries("stat_utils/CombinationsBatch", SMALL_BINOMIAL_MAX_N, [&table](Pairs& pairs) {
+        table.CombinationsBatch(pairs.n.data(), pairs.k.data(), pairs.result.data(), pairs.n.size());
+    });
+
+    runSeries("stat_utils/lgamma", LOG_MAX_N, [](Pairs& pairs) {
+        for (std::size_t i = 0; i < pairs.n.size(); i++) {
+            const double nValue = static_cast<double>(pairs.n[i]);
+            const double kValue = static_cast<double>(pairs.k[i]);
+            pairs.logResult[i] = std::lgamma(nValue + 1) - std::lgamma(kValue + 1) - std::lgamma(nValue - kValue + 1);
+        }
+    });
+
+    runSeries("stat_utils/LogCombinationsBatch", LOG_MAX_N, [&table](Pairs& pairs) {
+        table.LogCombinationsBatch(pairs.n.data(), pairs.k.data(), pairs.logResult.data(), pairs.n.size());
+    });
+}
+
+int InitBenchParams(int argc, char* argv[], BenchOptions& options) {
+    static struct option long_options[] = {
+        {"max_elements", required_argument, nullptr, 'n'},
+        {"max_crossstitch", required_argument, nullptr, 'c'},
+        {"repeats", required_argument, nullptr, 'r'},
+        {"threads", required_argument, nullptr, 't'},
+        {"json", required_argument, nullptr, 'j'},
+        {"filter", required_argument, nullptr, 'f'},
+        {"table", required_argument, nullptr, 'T'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, no_argument, nullptr, 0}
+    };
+
+    int opt;
+    int option_index = 0;
+    const static char shortOptions[] = "n:c:r:t:j:f:T:h";
+    while ((opt = getopt_long(argc, argv, shortOptions, long_options, &option_index)) != -1) {
+        try {
+            switch (opt) {
+                case 'n':
+                    options.maxElements = static_cast<std::uint64_t>(std::stod(optarg));
+                    break;
+                case 'c':
+                    options.maxCrossStitch = std::stoi(optarg);
+                    break;
+                case 'r':
+                    options.repeats = std::max(1, std::stoi(optarg));
+                    break;
+                case 't':
+                    options.threads = static_cast<unsigned>(std::stoul(optarg));
+                    break;
+                case 'j':
+                    options.jsonPath = optarg;
+                    break;
+                case 'f':
+                    options.filter = optarg;
+                    break;
+                case 'T':
+                    options.tablePath = optarg;
+                    break;
+                case 'h':
+                    std::cout << "Usage: " << argv[0] << " [OPTIONS]\n\n";
+                    std::cout << "  -n, --max_elements N      The largest compaction buffer, e.g. 1e9 (default 1e8).\n";
+                    std::cout << "  -c, --max_crossstitch N   The largest n = m = k for the DP engines (default 2000).\n";
+                    std::cout << "  -r, --repeats N           Report the best of N runs (default 3).\n";
+                    std::cout << "  -t, --threads N           Threads for the parallel kernels (default: all cores).\n";
+                    std::cout << "  -j, --json FILE           Write the results as JSON.\n";
+                    std::cout << "  -f, --filter TEXT         Only run the series whose names contain TEXT.\n";
+                    std::cout << "  -T, --table FILE          Scratch file for the answer table (default leet_bench_crossstitch.bin).\n";
+                    std::cout << "  -h, --help                Show this help message and exit.\n";
+                    return 1;
+                default:
+                    std::cerr << "Try '" << argv[0] << " --help' for more information.\n";
+                    return 1;
+            }
+        } catch (...) {
+            std::cerr << "Invalid number for option -" << static_cast<char>(opt) << ": " << optarg << "\n";
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (InitBenchParams(argc, argv, options) != 0) {
+        return 1;
+    }
+
+    BenchRunner runner(options);
+    std::cout << std::left << std::setw(40) << "series" << std::right << std::setw(14) << "size"
+              << std::setw(17) << "best time" << std::setw(16) << "throughput"
+              << std::setw(15) << "bandwidth" << std::setw(16) << "peak RSS" << std::setw(14) << "growth" << std::endl;
+
+    RunCompactionBenchmarks(runner, options);
+    RunCrossStitchBenchmarks(runner, options);
+    RunStatUtilsBenchmarks(runner);
+    runner.FitComplexities();
+
+    if (!options.jsonPath.empty()) {
+        runner.WriteJson(options.jsonPath);
+        std::cout << "\nThe results are written to " << options.jsonPath << std::endl;
+    }
+
+    return 0;
+}
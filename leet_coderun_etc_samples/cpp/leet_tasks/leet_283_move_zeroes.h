@@ -7,8 +7,8 @@
  * Given an integer array nums, move all 0's to the end of it
  * while maintaining the relative order of the non-zero elements.
  *
- * Approach: Two-pointer technique (in-place)
- * - Count zeros and shift non-zero elements to the left
+ * Approach: Stream compaction (in-place), see stream_compaction.h
+ * - Compact the non-zero elements to the left with the SIMD kernels
  * - Fill the remaining positions with zeros
  *
  * Time Complexity: O(n) - single pass through the array
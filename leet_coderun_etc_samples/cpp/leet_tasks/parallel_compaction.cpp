@@ -0,0 +1,113 @@
+#include <atomic>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include "parallel_compaction.h"
+
+namespace compaction {
+
+unsigned ResolveThreads(const unsigned threads) {
+    if (threads != 0) {
+        return threads;
+    }
+
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void ParallelFor(const std::size_t count, unsigned threads, const std::function<void(std::size_t)>& func) {
+    threads = static_cast<unsigned>(std::min<std::size_t>(ResolveThreads(threads), count));
+    if (threads <= 1) {
+        for (std::size_t i = 0; i < count; i++) {
+            func(i);
+        }
+        return;
+    }
+
+    std::atomic<std::size_t> next {0};
+    auto worker = [&]() {
+        for (std::size_t i = next++; i < count; i = next++) {
+            func(i);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; i++) {
+        workers.emplace_back(worker);
+    }
+    worker();
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+}
+
+MappedFile::MappedFile(const std::string& path) {
+    fd = open(path.c_str(), O_RDWR);
+    if (fd < 0) {
+        throw std::runtime_error("Can't open the file: " + path);
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0) {
+        close(fd);
+        throw std::runtime_error("Can't get the size of the file: " + path);
+    }
+
+    size = fileStat.st_size;
+    if (size == 0) {
+        return;
+    }
+
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        close(fd);
+        throw std::runtime_error("Can't map the file: " + path);
+    }
+
+    data = static_cast<char*>(mapping);
+    madvise(data, size, MADV_SEQUENTIAL);
+}
+
+MappedFile::~MappedFile() {
+    if (data != nullptr) {
+        munmap(data, size);
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+void MappedFile::Release(const std::size_t begin, const std::size_t end) {
+    const std::size_t pageSize = sysconf(_SC_PAGESIZE);
+    const std::size_t alignedBegin = begin / pageSize * pageSize;
+    const std::size_t alignedEnd = std::min(end, size) / pageSize * pageSize;
+    if (data == nullptr || alignedBegin >= alignedEnd) {
+        return;
+    }
+
+    msync(data + alignedBegin, alignedEnd - alignedBegin, MS_ASYNC);
+    madvise(data + alignedBegin, alignedEnd - alignedBegin, MADV_DONTNEED);
+}
+
+void MappedFile::CloseAndTruncate(const std::size_t newSize) {
+    if (data != nullptr) {
+        const bool synced = msync(data, size, MS_SYNC) == 0;
+        munmap(data, size);
+        data = nullptr;
+        if (!synced) {
+            throw std::runtime_error("Can't write the changes back to the file.");
+        }
+    }
+
+    if (newSize != size && ftruncate(fd, newSize) != 0) {
+        throw std::runtime_error("Can't truncate the file.");
+    }
+
+    close(fd);
+    fd = -1;
+    size = newSize;
+}
+
+} // namespace compaction
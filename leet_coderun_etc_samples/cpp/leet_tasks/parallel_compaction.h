@@ -0,0 +1,211 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "stream_compaction.h"
+
+/**
+ * Multi-threaded and out-of-core stream compaction, built on top of the
+ * single-threaded kernels of stream_compaction.h.
+ */
+namespace compaction {
+
+/**
+ * Runs func(0), ..., func(count - 1) on up to threads threads (0 means
+ * std::thread::hardware_concurrency()); the calling thread takes part in the work.
+ */
+void ParallelFor(const std::size_t count, unsigned threads, const std::function<void(std::size_t)>& func);
+
+/**
+ * Resolves the requested number of threads, 0 means std::thread::hardware_concurrency().
+ */
+unsigned ResolveThreads(const unsigned threads);
+
+/**
+ * Parallel stable compaction.
+ *
+ * 1. The buffer is split into chunks, and every chunk is compacted in place by a worker.
+ * 2. The exclusive prefix sum of the kept counts gives the output offset of every chunk.
+ *    There are only a few chunks per thread, so the scan itself is serial.
+ * 3. The kept parts of the chunks are moved to their offsets. The destination of a chunk
+ *    may overlap the kept parts of earlier chunks that haven't moved yet, so in-place moves
+ *    would have to run one after another. Instead the output after the first chunk, which
+ *    never moves, is produced in rounds through a bounded scratch buffer: a round gathers
+ *    its range of the output into the scratch in parallel and copies it back in parallel.
+ *    Every kept element lies at or after its destination, so the sources of the later
+ *    rounds lie after the range written by the current one and are still intact.
+ *
+ * Extra memory: O(threads * SCRATCH_BYTES_PER_THREAD) regardless of the size.
+ *
+ * @param threads Number of worker threads, 0 means std::thread::hardware_concurrency().
+ * @return The number of kept elements, which are moved to the beginning of data.
+ */
+template <typename T, typename TPredicate>
+std::size_t ParallelStableCompact(T* data, const std::size_t size, TPredicate keep, unsigned threads = 0) {
+    // Chunks smaller than this are not worth a worker
+    constexpr std::size_t MIN_CHUNK_SIZE = 1 << 16;
+    constexpr std::size_t CHUNKS_PER_THREAD = 4;
+    constexpr std::size_t SCRATCH_BYTES_PER_THREAD = std::size_t(4) << 20;
+
+    threads = ResolveThreads(threads);
+    const std::size_t chunksCount = std::max<std::size_t>(1, std::min(threads * CHUNKS_PER_THREAD, size / MIN_CHUNK_SIZE));
+    if (threads == 1 || chunksCount == 1) {
+        return StableCompact(data, size, keep);
+    }
+
+    const std::size_t chunkSize = (size + chunksCount - 1) / chunksCount;
+    std::vector<std::size_t> starts(chunksCount);
+    std::vector<std::size_t> kept(chunksCount);
+    ParallelFor(chunksCount, threads, [&](const std::size_t chunk) {
+        starts[chunk] = std::min(size, chunk * chunkSize);
+        const std::size_t length = std::min(size, starts[chunk] + chunkSize) - starts[chunk];
+        kept[chunk] = StableCompact(data + starts[chunk], length, keep);
+    });
+
+    std::vector<std::size_t> offsets(chunksCount);
+    std::size_t total = 0;
+    for (std::size_t chunk = 0; chunk < chunksCount; chunk++) {
+        offsets[chunk] = total;
+        total += kept[chunk];
+    }
+
+    const std::size_t firstKept = kept[0];
+    if (total == firstKept) {
+        return total;
+    }
+
+    // Not value-initialized: every element is written by the gather
+    const std::size_t roundSize = std::min(total - firstKept, std::max<std::size_t>(1, threads * SCRATCH_BYTES_PER_THREAD / sizeof(T)));
+    std::unique_ptr<T[]> scratch(new T[roundSize]);
+
+    for (std::size_t roundBegin = firstKept; roundBegin < total; roundBegin += roundSize) {
+        const std::size_t roundEnd = std::min(total, roundBegin + roundSize);
+        const std::size_t slicesCount = std::max<std::size_t>(1, std::min<std::size_t>(threads, (roundEnd - roundBegin) / MIN_CHUNK_SIZE));
+        const std::size_t sliceSize = (roundEnd - roundBegin + slicesCount - 1) / slicesCount;
+
+        // Gather the output positions [roundBegin, roundEnd) from the chunks containing them
+        ParallelFor(slicesCount, threads, [&](const std::size_t slice) {
+            std::size_t position = std::min(roundEnd, roundBegin + slice * sliceSize);
+            const std::size_t sliceEnd = std::min(roundEnd, position + sliceSize);
+            if (position >= sliceEnd) {
+                return;
+            }
+
+            // The last chunk starting at or before position is the one containing it
+            std::size_t chunk = std::upper_bound(offsets.begin(), offsets.end(), position) - offsets.begin() - 1;
+            for (; position < sliceEnd; chunk++) {
+                const std::size_t length = std::min(sliceEnd, offsets[chunk] + kept[chunk]) - position;
+                std::memcpy(scratch.get() + position - roundBegin, data + starts[chunk] + position - offsets[chunk], length * sizeof(T));
+                position += length;
+            }
+        });
+
+        ParallelFor(slicesCount, threads, [&](const std::size_t slice) {
+            const std::size_t begin = std::min(roundEnd - roundBegin, slice * sliceSize);
+            const std::size_t end = std::min(roundEnd - roundBegin, begin + sliceSize);
+            std::memcpy(data + roundBegin + begin, scratch.get() + begin, (end - begin) * sizeof(T));
+        });
+    }
+
+    return total;
+}
+
+template <typename T, typename TPredicate>
+std::size_t ParallelStableCompact(std::vector<T>& data, TPredicate keep, unsigned threads = 0) {
+    return ParallelStableCompact(data.data(), data.size(), keep, threads);
+}
+
+/**
+ * A read-write shared memory mapping of a whole file.
+ */
+class MappedFile {
+public:
+    /**
+     * @throws std::runtime_error if the file can't be opened or mapped.
+     */
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    char* Data() const { return data; }
+    std::size_t Size() const { return size; }
+
+    /**
+     * Starts the write-back of [begin, end) and drops these pages from the process,
+     * which keeps the resident memory bounded while walking over a large file.
+     * Both ends are aligned down to pages; touching a released page again just maps it back.
+     */
+    void Release(const std::size_t begin, const std::size_t end);
+
+    /**
+     * Writes all the changes back, unmaps the file and truncates it to newSize bytes.
+     *
+     * @throws std::runtime_error if the file can't be synchronized or truncated.
+     */
+    void CloseAndTruncate(const std::size_t newSize);
+
+private:
+    int fd = -1;
+    char* data = nullptr;
+    std::size_t size = 0;
+};
+
+/**
+ * Out-of-core compaction options.
+ */
+struct FileCompactionOptions {
+    std::size_t windowBytes = std::size_t(64) << 20; ///< Elements are compacted in windows of this size.
+    unsigned threads = 0; ///< Worker threads per window, 0 means std::thread::hardware_concurrency().
+    bool truncate = true; ///< Truncate the file to the kept elements; otherwise the contents of the tail are unspecified.
+};
+
+/**
+ * Compacts a file of T records in place through a memory mapping.
+ *
+ * The file is walked window by window: a window is compacted in parallel and its kept
+ * records are moved right after the previously kept ones. The write position never
+ * passes the read position, and the pages behind both are released after every window,
+ * so the resident memory stays around a couple of windows regardless of the file size.
+ *
+ * @return The number of kept records.
+ * @throws std::runtime_error if the file size is not a multiple of sizeof(T) or on I/O errors.
+ */
+template <typename T, typename TPredicate>
+std::size_t CompactFile(const std::string& path, TPredicate keep, const FileCompactionOptions& options = {}) {
+    MappedFile file(path);
+    if (file.Size() % sizeof(T) != 0) {
+        throw std::runtime_error("The file size is not a multiple of the record size: " + path);
+    }
+
+    T* records = reinterpret_cast<T*>(file.Data());
+    const std::size_t recordsCount = file.Size() / sizeof(T);
+    const std::size_t windowRecords = std::max<std::size_t>(1, options.windowBytes / sizeof(T));
+
+    std::size_t out = 0;
+    std::size_t released = 0;
+    for (std::size_t window = 0; window < recordsCount; window += windowRecords) {
+        const std::size_t length = std::min(windowRecords, recordsCount - window);
+        const std::size_t kept = ParallelStableCompact(records + window, length, keep, options.threads);
+        if (kept > 0 && out != window) {
+            std::memmove(records + out, records + window, kept * sizeof(T));
+        }
+
+        // Everything before the write position is final, and the rest of the window is already read
+        out += kept;
+        file.Release(released, (window + length) * sizeof(T));
+        released = (window + length) * sizeof(T);
+    }
+
+    file.CloseAndTruncate(options.truncate ? out * sizeof(T) : file.Size());
+    return out;
+}
+
+} // namespace compaction
@@ -0,0 +1,348 @@
+#include "stream_compaction.h"
+
+// The SIMD kernels are x86 only, other targets always use the scalar loop
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COMPACTION_X86 1
+#endif
+
+namespace compaction {
+
+namespace {
+
+#ifdef COMPACTION_X86
+
+/**
+ * AVX2 has no compress instruction, so the kept lanes are gathered with a permutation
+ * looked up by the keep mask: 8 lanes of 32 bits give 256 permutations.
+ * The permutation of the 64-bit lanes is expressed in pairs of 32-bit lanes.
+ * 8 and 16-bit lanes are gathered by pshufb with byte shuffles, 8 lanes per lookup.
+ */
+struct PermutationTables {
+    alignas(32) std::int32_t lanes32[256][8] = {};
+    alignas(32) std::int32_t lanes64[16][8] = {};
+    alignas(16) std::uint64_t lanes8[256] = {}; ///< 8 byte indices packed into a 64-bit word
+    alignas(16) std::uint8_t lanes16[256][16] = {};
+
+    PermutationTables() {
+        for (int mask = 0; mask < 256; mask++) {
+            int out = 0;
+            for (int lane = 0; lane < 8; lane++) {
+                if (mask & (1 << lane)) {
+                    lanes8[mask] |= static_cast<std::uint64_t>(lane) << (8 * out);
+                    lanes16[mask][2 * out] = 2 * lane;
+                    lanes16[mask][2 * out + 1] = 2 * lane + 1;
+                    out++;
+                }
+            }
+        }
+
+        for (int mask = 0; mask < 256; mask++) {
+            int out = 0;
+            for (int lane = 0; lane < 8; lane++) {
+                if (mask & (1 << lane)) {
+                    lanes32[mask][out++] = lane;
+                }
+            }
+        }
+
+        for (int mask = 0; mask < 16; mask++) {
+            int out = 0;
+            for (int lane = 0; lane < 4; lane++) {
+                if (mask & (1 << lane)) {
+                    lanes64[mask][out++] = 2 * lane;
+                    lanes64[mask][out++] = 2 * lane + 1;
+                }
+            }
+        }
+    }
+};
+
+const PermutationTables PERMUTATION_TABLES;
+
+struct CpuFeatures {
+    bool avx2 = false;
+    bool avx512 = false; ///< AVX512F and AVX512BW
+    bool avx512Vbmi2 = false; ///< Byte and word compress
+
+    CpuFeatures() {
+        __builtin_cpu_init();
+        avx2 = __builtin_cpu_supports("avx2");
+        avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+        avx512Vbmi2 = avx512 && __builtin_cpu_supports("avx512vbmi2");
+    }
+};
+
+const CpuFeatures& GetCpuFeatures() {
+    static const CpuFeatures features;
+    return features;
+}
+
+#endif // COMPACTION_X86
+
+/**
+ * The requested instruction set, lowered to what the CPU supports.
+ */
+Isa SupportedIsa([[maybe_unused]] const Isa isa) {
+#ifdef COMPACTION_X86
+    const CpuFeatures& features = GetCpuFeatures();
+    if (isa == Isa::Avx512 && features.avx512) {
+        return Isa::Avx512;
+    }
+
+    if (isa != Isa::Scalar && features.avx2) {
+        return Isa::Avx2;
+    }
+#endif
+
+    return Isa::Scalar;
+}
+
+#ifdef COMPACTION_X86
+
+/**
+ * AVX2 kernel for 32 and 64-bit elements. The full vector store at out <= i only
+ * overwrites elements which are already loaded.
+ */
+template <typename T>
+__attribute__((target("avx2,popcnt")))
+std::size_t Avx2Compact(T* data, const std::size_t size, const T value) {
+    static_assert(sizeof(T) == 4 || sizeof(T) == 8);
+    constexpr std::size_t LANES = 32 / sizeof(T);
+
+    std::size_t out = 0;
+    std::size_t i = 0;
+    for (; i + LANES <= size; i += LANES) {
+        const __m256i vector = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        int keepMask;
+        if constexpr (std::is_same_v<T, float>) {
+            keepMask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_castsi256_ps(vector), _mm256_set1_ps(value), _CMP_NEQ_UQ));
+        } else if constexpr (std::is_same_v<T, double>) {
+            keepMask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_castsi256_pd(vector), _mm256_set1_pd(value), _CMP_NEQ_UQ));
+        } else if constexpr (sizeof(T) == 4) {
+            keepMask = ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(vector, _mm256_set1_epi32(value)))) & 0xFF;
+        } else {
+            keepMask = ~_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(vector, _mm256_set1_epi64x(value)))) & 0xF;
+        }
+
+        const std::int32_t* permutation;
+        if constexpr (sizeof(T) == 4) {
+            permutation = PERMUTATION_TABLES.lanes32[keepMask];
+        } else {
+            permutation = PERMUTATION_TABLES.lanes64[keepMask];
+        }
+
+        const __m256i compressed = _mm256_permutevar8x32_epi32(
+            vector, _mm256_load_si256(reinterpret_cast<const __m256i*>(permutation)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + out), compressed);
+        out += __builtin_popcount(keepMask);
+    }
+
+    for (; i < size; i++) {
+        if (data[i] != value) {
+            data[out++] = data[i];
+        }
+    }
+
+    return out;
+}
+
+/**
+ * AVX2 kernel for 8 and 16-bit elements, for the CPUs without AVX512_VBMI2.
+ * pshufb doesn't cross 128-bit lanes, so 16 bytes are processed per step: two halves
+ * of 8 bytes for int8_t and 8 lanes for int16_t. Every store at out <= i only overwrites
+ * elements which are already loaded.
+ */
+template <typename T>
+__attribute__((target("avx2,popcnt")))
+std::size_t Avx2SmallCompact(T* data, const std::size_t size, const T value) {
+    static_assert(sizeof(T) == 1 || sizeof(T) == 2);
+    constexpr std::size_t LANES = 16 / sizeof(T);
+
+    std::size_t out = 0;
+    std::size_t i = 0;
+    for (; i + LANES <= size; i += LANES) {
+        const __m128i vector = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        if constexpr (sizeof(T) == 1) {
+            const unsigned keepMask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(vector, _mm_set1_epi8(value))) & 0xFFFF;
+            const unsigned lowMask = keepMask & 0xFF;
+            const unsigned highMask = keepMask >> 8;
+
+            // The high half shuffle picks the bytes 8..15
+            const __m128i shuffle = _mm_set_epi64x(
+                static_cast<long long>(PERMUTATION_TABLES.lanes8[highMask] + 0x0808080808080808ULL),
+                static_cast<long long>(PERMUTATION_TABLES.lanes8[lowMask]));
+            const __m128i compressed = _mm_shuffle_epi8(vector, shuffle);
+
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(data + out), compressed);
+            out += __builtin_popcount(lowMask);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(data + out), _mm_unpackhi_epi64(compressed, compressed));
+            out += __builtin_popcount(highMask);
+        } else {
+            const __m128i equal = _mm_cmpeq_epi16(vector, _mm_set1_epi16(value));
+            const unsigned keepMask = ~_mm_movemask_epi8(_mm_packs_epi16(equal, _mm_setzero_si128())) & 0xFF;
+            const __m128i compressed = _mm_shuffle_epi8(
+                vector, _mm_load_si128(reinterpret_cast<const __m128i*>(PERMUTATION_TABLES.lanes16[keepMask])));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(data + out), compressed);
+            out += __builtin_popcount(keepMask);
+        }
+    }
+
+    for (; i < size; i++) {
+        if (data[i] != value) {
+            data[out++] = data[i];
+        }
+    }
+
+    return out;
+}
+
+/**
+ * AVX-512 kernel for 32 and 64-bit elements. The compress is done in a register and
+ * followed by a full vector store, which is faster than the compress store to memory.
+ */
+template <typename T>
+__attribute__((target("avx512f,avx512bw,popcnt")))
+std::size_t Avx512Compact(T* data, const std::size_t size, const T value) {
+    static_assert(sizeof(T) == 4 || sizeof(T) == 8);
+    constexpr std::size_t LANES = 64 / sizeof(T);
+
+    std::size_t out = 0;
+    std::size_t i = 0;
+    for (; i + LANES <= size; i += LANES) {
+        const __m512i vector = _mm512_loadu_si512(data + i);
+        __m512i compressed;
+        unsigned keepMask;
+        if constexpr (std::is_same_v<T, float>) {
+            const __mmask16 mask = _mm512_cmp_ps_mask(_mm512_castsi512_ps(vector), _mm512_set1_ps(value), _CMP_NEQ_UQ);
+            compressed = _mm512_maskz_compress_epi32(mask, vector);
+            keepMask = mask;
+        } else if constexpr (std::is_same_v<T, double>) {
+            const __mmask8 mask = _mm512_cmp_pd_mask(_mm512_castsi512_pd(vector), _mm512_set1_pd(value), _CMP_NEQ_UQ);
+            compressed = _mm512_maskz_compress_epi64(mask, vector);
+            keepMask = mask;
+        } else if constexpr (sizeof(T) == 4) {
+            const __mmask16 mask = _mm512_cmpneq_epi32_mask(vector, _mm512_set1_epi32(value));
+            compressed = _mm512_maskz_compress_epi32(mask, vector);
+            keepMask = mask;
+        } else {
+            const __mmask8 mask = _mm512_cmpneq_epi64_mask(vector, _mm512_set1_epi64(value));
+            compressed = _mm512_maskz_compress_epi64(mask, vector);
+            keepMask = mask;
+        }
+
+        _mm512_storeu_si512(data + out, compressed);
+        out += __builtin_popcount(keepMask);
+    }
+
+    for (; i < size; i++) {
+        if (data[i] != value) {
+            data[out++] = data[i];
+        }
+    }
+
+    return out;
+}
+
+/**
+ * AVX-512 kernel for 8 and 16-bit elements, their compress needs AVX512_VBMI2.
+ */
+template <typename T>
+__attribute__((target("avx512f,avx512bw,avx512vbmi2,popcnt")))
+std::size_t Avx512Vbmi2Compact(T* data, const std::size_t size, const T value) {
+    static_assert(sizeof(T) == 1 || sizeof(T) == 2);
+    constexpr std::size_t LANES = 64 / sizeof(T);
+
+    std::size_t out = 0;
+    std::size_t i = 0;
+    for (; i + LANES <= size; i += LANES) {
+        const __m512i vector = _mm512_loadu_si512(data + i);
+        __m512i compressed;
+        std::uint64_t keepMask;
+        if constexpr (sizeof(T) == 1) {
+            const __mmask64 mask = _mm512_cmpneq_epi8_mask(vector, _mm512_set1_epi8(value));
+            compressed = _mm512_maskz_compress_epi8(mask, vector);
+            keepMask = mask;
+        } else {
+            const __mmask32 mask = _mm512_cmpneq_epi16_mask(vector, _mm512_set1_epi16(value));
+            compressed = _mm512_maskz_compress_epi16(mask, vector);
+            keepMask = mask;
+        }
+
+        _mm512_storeu_si512(data + out, compressed);
+        out += __builtin_popcountll(keepMask);
+    }
+
+    for (; i < size; i++) {
+        if (data[i] != value) {
+            data[out++] = data[i];
+        }
+    }
+
+    return out;
+}
+
+#endif // COMPACTION_X86
+
+/**
+ * Selects the kernel for the element type and the instruction set.
+ */
+template <typename T>
+std::size_t DispatchCompact(T* data, const std::size_t size, const T value, [[maybe_unused]] const Isa isa) {
+#ifdef COMPACTION_X86
+    const Isa supported = SupportedIsa(isa);
+    if constexpr (sizeof(T) <= 2) {
+        if (supported == Isa::Avx512 && GetCpuFeatures().avx512Vbmi2) {
+            return Avx512Vbmi2Compact(data, size, value);
+        }
+
+        if (supported != Isa::Scalar) {
+            return Avx2SmallCompact(data, size, value);
+        }
+    } else {
+        if (supported == Isa::Avx512) {
+            return Avx512Compact(data, size, value);
+        }
+
+        if (supported == Isa::Avx2) {
+            return Avx2Compact(data, size, value);
+        }
+    }
+#endif
+
+    return ScalarCompact(data, size, NotEqual<T>{value});
+}
+
+} // namespace
+
+Isa DetectIsa() {
+    static const Isa isa = SupportedIsa(Isa::Avx512);
+    return isa;
+}
+
+std::size_t CompactNotEqual(std::int8_t* data, const std::size_t size, const std::int8_t value, const Isa isa) {
+    return DispatchCompact(data, size, value, isa);
+}
+
+std::size_t CompactNotEqual(std::int16_t* data, const std::size_t size, const std::int16_t value, const Isa isa) {
+    return DispatchCompact(data, size, value, isa);
+}
+
+std::size_t CompactNotEqual(std::int32_t* data, const std::size_t size, const std::int32_t value, const Isa isa) {
+    return DispatchCompact(data, size, value, isa);
+}
+
+std::size_t CompactNotEqual(std::int64_t* data, const std::size_t size, const std::int64_t value, const Isa isa) {
+    return DispatchCompact(data, size, value, isa);
+}
+
+std::size_t CompactNotEqual(float* data, const std::size_t size, const float value, const Isa isa) {
+    return DispatchCompact(data, size, value, isa);
+}
+
+std::size_t CompactNotEqual(double* data, const std::size_t size, const double value, const Isa isa) {
+    return DispatchCompact(data, size, value, isa);
+}
+
+} // namespace compaction
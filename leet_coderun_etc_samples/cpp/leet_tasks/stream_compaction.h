@@ -0,0 +1,133 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Stream compaction: the generalization of LeetCode 283 (Move Zeroes).
+ *
+ * Removes the elements that don't satisfy a predicate from a buffer in-place,
+ * keeping the relative order of the remaining ones, e.g. to strip empty slots
+ * from large buffers.
+ *
+ * For the NotEqual predicate and the element types int8_t, int16_t, int32_t,
+ * int64_t, float and double the work is done by SIMD compress kernels, selected
+ * at runtime by the CPU features:
+ * - AVX-512: masked compress for 32/64-bit elements (AVX512F + AVX512BW),
+ *   and for 8/16-bit elements if AVX512_VBMI2 is available;
+ * - AVX2: permutation table driven compress: vpermd for 32/64-bit elements,
+ *   pshufb for 8/16-bit ones (also used on AVX-512 CPUs without AVX512_VBMI2);
+ * - scalar loop otherwise, and always on non-x86 targets.
+ * Any other predicate uses the scalar loop.
+ *
+ * Time Complexity: O(n), Space Complexity: O(1).
+ */
+namespace compaction {
+
+/**
+ * The instruction set used by the compaction kernels.
+ */
+enum class Isa {
+    Scalar,
+    Avx2,
+    Avx512,
+};
+
+/**
+ * The best instruction set supported by the CPU, detected once.
+ */
+Isa DetectIsa();
+
+/**
+ * The predicate keeping the elements not equal to value.
+ * For floating point types NaN is never equal, so it is kept, and -0.0 == 0.0.
+ */
+template <typename T>
+struct NotEqual {
+    T value;
+
+    bool operator()(const T x) const {
+        return x != value;
+    }
+};
+
+/**
+ * SIMD-dispatched kernels: compact the elements not equal to value to the beginning of data.
+ *
+ * @param isa The instruction set to use; if the CPU doesn't support it, the best supported one is used.
+ * @return The number of kept elements.
+ */
+std::size_t CompactNotEqual(std::int8_t* data, const std::size_t size, const std::int8_t value, const Isa isa = DetectIsa());
+std::size_t CompactNotEqual(std::int16_t* data, const std::size_t size, const std::int16_t value, const Isa isa = DetectIsa());
+std::size_t CompactNotEqual(std::int32_t* data, const std::size_t size, const std::int32_t value, const Isa isa = DetectIsa());
+std::size_t CompactNotEqual(std::int64_t* data, const std::size_t size, const std::int64_t value, const Isa isa = DetectIsa());
+std::size_t CompactNotEqual(float* data, const std::size_t size, const float value, const Isa isa = DetectIsa());
+std::size_t CompactNotEqual(double* data, const std::size_t size, const double value, const Isa isa = DetectIsa());
+
+template <typename T>
+constexpr bool IsSimdCompactable = std::is_same_v<T, std::int8_t>
+    || std::is_same_v<T, std::int16_t>
+    || std::is_same_v<T, std::int32_t>
+    || std::is_same_v<T, std::int64_t>
+    || std::is_same_v<T, float>
+    || std::is_same_v<T, double>;
+
+/**
+ * Scalar stable compaction with an arbitrary predicate.
+ *
+ * @return The number of kept elements, which are moved to the beginning of data.
+ */
+template <typename T, typename TPredicate>
+std::size_t ScalarCompact(T* data, const std::size_t size, TPredicate keep) {
+    std::size_t out = 0;
+    for (std::size_t i = 0; i < size; i++) {
+        if (keep(data[i])) {
+            data[out++] = data[i];
+        }
+    }
+
+    return out;
+}
+
+/**
+ * Stable compaction: moves the elements satisfying keep to the beginning of data,
+ * keeping their relative order. The contents of the rest of the buffer are unspecified.
+ *
+ * @return The number of kept elements.
+ */
+template <typename T, typename TPredicate>
+std::size_t StableCompact(T* data, const std::size_t size, TPredicate keep) {
+    if constexpr (std::is_same_v<TPredicate, NotEqual<T>> && IsSimdCompactable<T>) {
+        return CompactNotEqual(data, size, keep.value);
+    } else {
+        return ScalarCompact(data, size, keep);
+    }
+}
+
+template <typename T, typename TPredicate>
+std::size_t StableCompact(std::vector<T>& data, TPredicate keep) {
+    return StableCompact(data.data(), data.size(), keep);
+}
+
+/**
+ * Stable partition by value: moves all the elements equal to value to the end of data,
+ * keeping the relative order of the others. Move Zeroes is MoveValueToEnd(data, size, 0).
+ *
+ * @return The number of elements not equal to value.
+ */
+template <typename T>
+std::size_t MoveValueToEnd(T* data, const std::size_t size, const T value) {
+    const std::size_t kept = StableCompact(data, size, NotEqual<T>{value});
+    std::fill(data + kept, data + size, value);
+    return kept;
+}
+
+template <typename T>
+std::size_t MoveValueToEnd(std::vector<T>& data, const T value) {
+    return MoveValueToEnd(data.data(), data.size(), value);
+}
+
+} // namespace compaction
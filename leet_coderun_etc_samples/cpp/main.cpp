@@ -1,9 +1,75 @@
 #include <leet_283_move_zeroes.h>
 #include "me_tasks/me_crossstitch_calc.h"
+#include "me_tasks/me_crossstitch_dp.h"
+#include "me_tasks/me_crossstitch_mc.h"
+#include "me_tasks/me_crossstitch_table.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <getopt.h>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
-int main(int, char**) {
+/**
+ * @brief Answers kitten stitch queries in bulk.
+ *
+ * Reads "n m k" triples from the input file and writes "n m k p_n p_m p_k" lines to the output file.
+ * If a table is given, the queries inside of it are looked up, the rest are calculated with the DP engine.
+ *
+ * @return int Returns 0 on success, and a non-zero value on error.
+ */
+int RunCrossStitchBatch(const std::string& inputPath, const std::string& outputPath, const std::string& tablePath) {
+    std::ifstream input(inputPath);
+    if (!input) {
+        std::cerr << "Error: Can't open the input file " << inputPath << "\n";
+        return 1;
+    }
+
+    std::ofstream output(outputPath);
+    if (!output) {
+        std::cerr << "Error: Can't open the output file " << outputPath << "\n";
+        return 1;
+    }
+
+    std::unique_ptr<crossstitch::CrossStitchTable> table;
+    if (!tablePath.empty()) {
+        table = std::make_unique<crossstitch::CrossStitchTable>(tablePath);
+    }
+
+    output << std::setprecision(std::numeric_limits<double>::max_digits10);
+    int nCount;
+    int mCount;
+    int kCount;
+    while (input >> nCount >> mCount >> kCount) {
+        std::vector<double> firstStitch;
+        if (table) {
+            firstStitch = table->Calc(nCount, mCount, kCount);
+        } else {
+            crossstitch::DpCrossStitch cross(nCount, mCount, kCount);
+            firstStitch = cross.Calc();
+        }
+
+        output << nCount << " " << mCount << " " << kCount << " "
+               << firstStitch[0] << " " << firstStitch[1] << " " << firstStitch[2] << "\n";
+    }
+
+    if (!input.eof()) {
+        std::cerr << "Error: The input file must contain triples of integers.\n";
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Runs the interactive checks, reading the tasks input from stdin.
+ */
+int RunInteractive() {
     // Check leet_283 solution
     std::cout << "Lets run leet_283 solution.\n";
 
@@ -34,7 +100,177 @@ int main(int, char**) {
     std::cin >> nCount >> mCount >> kCount;
 
     crossstitch::SimpleCrossStitch* cross = new crossstitch::SimpleCrossStitch(nCount, mCount, kCount);
-    std::vector<double> firstStitch = cross->Calc();
-    std::cout << "Result probabilities are: " << firstStitch[0] << ", " << firstStitch[1] << ", " << firstStitch[2] << std::endl;
+    try {
+        std::vector<double> firstStitch = cross->Calc();
+        std::cout << "Result probabilities are: " << firstStitch[0] << ", " << firstStitch[1] << ", " << firstStitch[2] << std::endl;
+    } catch (const std::overflow_error& e) {
+        std::cout << "The combinatorial solution can't handle these counts: " << e.what() << std::endl;
+    }
     delete cross;
+
+    // Cross-check with the dynamic programming solution, which also works for large counts
+    try {
+        crossstitch::DpCrossStitch dpCross(nCount, mCount, kCount);
+        std::vector<double> dpFirstStitch = dpCross.Calc();
+        std::cout << "DP result probabilities are: " << dpFirstStitch[0] << ", " << dpFirstStitch[1] << ", " << dpFirstStitch[2] << std::endl;
+    } catch (const std::invalid_argument& e) {
+        std::cout << "The DP solution can't handle these counts: " << e.what() << std::endl;
+    }
+
+    // And with a Monte Carlo estimation, keeping the number of simulated steps around 10^9
+    try {
+        crossstitch::MonteCarloCrossStitch mcCross(nCount, mCount, kCount);
+        const std::uint64_t trials = std::min<std::uint64_t>(10000000, 1000000000 / (nCount + mCount + kCount));
+        crossstitch::MonteCarloResult mcFirstStitch = mcCross.Calc(trials);
+        std::cout << "Monte Carlo result probabilities (" << trials << " trials, 95% CI) are:";
+        for (int i = 0; i < 3; i++) {
+            std::cout << (i > 0 ? ", " : " ") << mcFirstStitch.probabilities[i]
+                      << " [" << mcFirstStitch.lowerBounds[i] << ", " << mcFirstStitch.upperBounds[i] << "]";
+        }
+        std::cout << std::endl;
+    } catch (const std::invalid_argument& e) {
+        std::cout << "The Monte Carlo solution can't handle these counts: " << e.what() << std::endl;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Compares the dynamic programming solution with the combinatorial one on all the small counts.
+ *
+ * @return int Returns 0 if the solutions agree on every triple up to maxCount, and 1 otherwise.
+ */
+int RunCrossStitchCheck(const int maxCount) {
+    constexpr double TOLERANCE = 1e-12;
+
+    double maxError = 0.0;
+    int mismatches = 0;
+    for (int n = 1; n <= maxCount; n++) {
+        for (int m = 1; m <= maxCount; m++) {
+            for (int k = 1; k <= maxCount; k++) {
+                crossstitch::SimpleCrossStitch cross(n, m, k);
+                crossstitch::DpCrossStitch dpCross(n, m, k);
+                const std::vector<double> expected = cross.Calc();
+                const std::vector<double> actual = dpCross.Calc();
+                for (int i = 0; i < 3; i++) {
+                    const double error = std::abs(expected[i] - actual[i]);
+                    maxError = std::max(maxError, error);
+                    if (!(error <= TOLERANCE)) {
+                        std::cerr << "Mismatch for " << n << " " << m << " " << k << ": "
+                                  << expected[i] << " != " << actual[i] << "\n";
+                        mismatches++;
+                    }
+                }
+            }
+        }
+    }
+
+    std::cout << "Kitten stitch check up to " << maxCount << ": max difference " << maxError
+              << ", mismatches " << mismatches << std::endl;
+    return mismatches == 0 ? 0 : 1;
+}
+
+/**
+ * @brief Main entry point of the application.
+ *
+ * Without options runs the interactive checks. The options switch to the kitten stitch batch mode:
+ *   -g, --generate N   Precompute the answers for all the counts up to N into the --table file.
+ *   -t, --table FILE   Precomputed answers table.
+ *   -i, --input FILE   Batch mode: the file with "n m k" triples.
+ *   -o, --output FILE  Batch mode: the file for the answers.
+ *   -c, --check        Compare the DP solution with the combinatorial one on the small counts.
+ */
+int main(int argc, char* argv[]) {
+    if (argc == 1) {
+        return RunInteractive();
+    }
+
+    static struct option long_options[] = {
+        {"generate", required_argument, nullptr, 'g'},
+        {"table", required_argument, nullptr, 't'},
+        {"input", required_argument, nullptr, 'i'},
+        {"output", required_argument, nullptr, 'o'},
+        {"check", no_argument, nullptr, 'c'},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, no_argument, nullptr, 0}
+    };
+
+    int generateCount = 0;
+    std::string tablePath;
+    std::string inputPath;
+    std::string outputPath;
+    bool check = false;
+
+    int opt;
+    int option_index = 0;
+    const static char options[] = "g:t:i:o:ch";
+    while ((opt = getopt_long(argc, argv, options, long_options, &option_index)) != -1) {
+        switch (opt) {
+            case 'g':
+                try {
+                    generateCount = std::stoi(optarg);
+                } catch (...) {
+                    std::cerr << "Invalid number for --generate: " << optarg << "\n";
+                    return 1;
+                }
+
+                break;
+            case 't':
+                tablePath = optarg;
+                break;
+            case 'i':
+                inputPath = optarg;
+                break;
+            case 'o':
+                outputPath = optarg;
+                break;
+            case 'c':
+                check = true;
+                break;
+            case 'h':
+                std::cout << "Usage: " << argv[0] << " [OPTIONS]\n\n";
+                std::cout << "Without options runs the interactive checks reading from stdin.\n\n";
+                std::cout << "Kitten stitch batch options:\n";
+                std::cout << "  -g, --generate N      Precompute the answers for all the counts up to N into the --table file.\n";
+                std::cout << "  -t, --table FILE      Precomputed answers table.\n";
+                std::cout << "  -i, --input FILE      File with \"n m k\" triples to answer.\n";
+                std::cout << "  -o, --output FILE     File for the \"n m k p_n p_m p_k\" answers.\n";
+                std::cout << "  -c, --check           Compare the DP solution with the combinatorial one on the small counts.\n";
+                std::cout << "  -h, --help            Show this help message and exit.\n";
+                return 0;
+            default: // Handles unknown options
+                std::cerr << "Try '" << argv[0] << " --help' for more information.\n";
+                return 1;
+        }
+    }
+
+    try {
+        // All the triples up to 12 are within the combinatorial solution limit n + m + k - 2 <= 40
+        if (check && RunCrossStitchCheck(12) != 0) {
+            return 1;
+        }
+
+        if (generateCount != 0) {
+            if (tablePath.empty()) {
+                std::cerr << "Error: --generate requires the --table file to write.\n";
+                return 1;
+            }
+
+            crossstitch::GenerateCrossStitchTable(tablePath, generateCount);
+        }
+
+        if (!inputPath.empty() || !outputPath.empty()) {
+            if (inputPath.empty() || outputPath.empty()) {
+                std::cerr << "Error: The batch mode requires both --input and --output.\n";
+                return 1;
+            }
+
+            return RunCrossStitchBatch(inputPath, outputPath, tablePath);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
 }
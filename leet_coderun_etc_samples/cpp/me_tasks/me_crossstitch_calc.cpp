@@ -46,7 +46,7 @@ long SimpleCrossStitch::CalculateOneStepCombinations(const int work_range, const
     long result = 0;
     for (int k = 0; k < std::min(additional, other_n1-1) + 1; k++) {
         for (int m = additional-k; m < std::min(additional-k, other_n2-1) + 1; m++) {
-            result += CombinationsKN(work_range, k) * CombinationsKN(work_range-k, m);
+            result += binomials.Combinations(work_range, k) * binomials.Combinations(work_range-k, m);
         }
     }
 
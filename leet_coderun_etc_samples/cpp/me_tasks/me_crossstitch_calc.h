@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include "stat_utils.h"
 
 /**
  * The little cat loves fish, birds, and enjoying walks in the garden,
@@ -63,6 +64,7 @@ private:
     int mCount = 0; ///< Number of squares remaining for the bird picture.
     int kCount = 0; ///< Number of squares remaining for the garden picture.
     int maxCount = 0; ///< Maximum number of steps until one picture is complete.
+    stat_utils::BinomialTable binomials; ///< Table-backed binomial coefficients.
 };
 
 } // namespace crossstitch
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include <cfloat>
+#include <cmath>
+#include <stdexcept>
+#include "me_crossstitch_dp.h"
+
+namespace crossstitch {
+
+/**
+ * Constructor for DpCrossStitch.
+ *
+ * Initializes the problem with the number of remaining stitches for each of the three
+ * embroidery pictures: fish (n), birds (m), and garden (k).
+ */
+DpCrossStitch::DpCrossStitch(const int n, const int m, const int k)
+    : nCount(n)
+    , mCount(m)
+    , kCount(k)
+{
+    if (n <= 0 || m <= 0 || k <= 0) {
+        throw std::invalid_argument("The remaining squares counts must be positive.");
+    }
+};
+
+/**
+ * Calculate the probability for a given picture to be completed first.
+ */
+double DpCrossStitch::CalculateOneSampleProbability(const int n, const int other_n1, const int other_n2) {
+    // Probabilities of the states (j, l) of the two other pictures, summed over the diagonals j + l = t.
+    stateRow.assign(other_n2, 0.0);
+    diagonalSums.assign(other_n1 + other_n2 - 1, 0.0);
+    for (int j = 0; j < other_n1; j++) {
+        for (int l = 0; l < other_n2; l++) {
+            double value;
+            if (j == 0 && l == 0) {
+                value = 1.0;
+            } else {
+                value = 0.5 * (stateRow[l] + (l > 0 ? stateRow[l - 1] : 0.0));
+            }
+
+            // Flush values that are too small to matter, so the loop never runs on denormals.
+            stateRow[l] = value < DBL_MIN ? 0.0 : value;
+            diagonalSums[j + l] += stateRow[l];
+        }
+    }
+
+    // Weight each diagonal with the probability that the picture gets its (n-1)-th square
+    // together with t squares of the other pictures and then the final square.
+    const double logBase = -n * std::log(3.0) - std::lgamma(n);
+    const double logTwoThirds = std::log(2.0 / 3.0);
+    double result = 0.0;
+    for (int t = 0; t < static_cast<int>(diagonalSums.size()); t++) {
+        if (diagonalSums[t] == 0.0) {
+            continue;
+        }
+
+        const double logWeight = logBase + std::lgamma(n + t) - std::lgamma(t + 1) + t * logTwoThirds;
+        result += std::exp(logWeight) * diagonalSums[t];
+    }
+
+    return result;
+};
+
+/**
+ * Calculate the probabilities of each picture being completed first.
+ *
+ * Returns a vector containing the probabilities for the fish, bird, and garden pictures, respectively.
+ */
+std::vector<double> DpCrossStitch::Calc() {
+    std::vector<double> result = {
+        CalculateOneSampleProbability(nCount, mCount, kCount),
+        CalculateOneSampleProbability(mCount, nCount, kCount),
+        CalculateOneSampleProbability(kCount, nCount, mCount)
+    };
+
+    return result;
+};
+
+} // namespace crossstitch
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * The same kitten stitch task as in me_crossstitch_calc.h, solved with dynamic
+ * programming over the states of the remaining squares instead of enumerating
+ * the combinations, so it works for n, m and k in the thousands.
+ */
+namespace crossstitch {
+
+/**
+ * A class to calculate the probability of each picture being completed first
+ * with a dynamic programming engine.
+ *
+ * Picture A is completed first if, after A gets its (n-1)-th square with j squares
+ * of B and l squares of C embroidered (j < m, l < k), the next square goes to A.
+ * Such sequences have the probability
+ *     (n-1+j+l)! / ((n-1)! j! l!) * 3^-(n+j+l)
+ *   = [C(n-1+t, t) * 3^-n * (2/3)^t] * [C(t, j) * 2^-t],   t = j + l.
+ * The first factor is computed in log space, the second one is the probability
+ * of reaching the state (j, l) of the two other pictures and is filled row by row
+ * with g(j, l) = (g(j-1, l) + g(j, l-1)) / 2, keeping only one row in memory.
+ *
+ * Time complexity: O(n*m + n*k + m*k), memory: O(n + m + k).
+ */
+class DpCrossStitch {
+public:
+    /**
+     * Constructor for DpCrossStitch.
+     *
+     * @param n Number of squares remaining to embroider on the fish picture.
+     * @param m Number of squares remaining to embroider on the bird picture.
+     * @param k Number of squares remaining to embroider on the garden picture.
+     *
+     * @throws std::invalid_argument if any of the counts is not positive.
+     */
+    explicit DpCrossStitch(const int n, const int m, const int k);
+
+    /**
+     * Calculate the probabilities of each picture being completed first.
+     *
+     * @return A vector containing the probabilities for the fish, bird, and garden pictures, respectively.
+     */
+    std::vector<double> Calc();
+
+protected:
+    /**
+     * Calculate the probability for a given picture to be completed first.
+     *
+     * @param n The number of remaining squares for the picture being considered.
+     * @param other_n1 The number of remaining squares for the first other picture.
+     * @param other_n2 The number of remaining squares for the second other picture.
+     * @return The probability for the picture to be completed first.
+     */
+    double CalculateOneSampleProbability(const int n, const int other_n1, const int other_n2);
+
+private:
+    int nCount = 0; ///< Number of squares remaining for the fish picture.
+    int mCount = 0; ///< Number of squares remaining for the bird picture.
+    int kCount = 0; ///< Number of squares remaining for the garden picture.
+
+    std::vector<double> stateRow; ///< Reused row of the (other_n1, other_n2) state probabilities.
+    std::vector<double> diagonalSums; ///< Reused sums of the state probabilities over j + l = t.
+};
+
+} // namespace crossstitch
@@ -0,0 +1,39 @@
+#include "me_crossstitch_k.h"
+
+namespace crossstitch {
+
+/**
+ * Constructor for RuntimeCrossStitch.
+ *
+ * An empty weights vector means that every picture is selected with the same probability.
+ */
+RuntimeCrossStitch::RuntimeCrossStitch(const std::vector<int>& counts, const std::vector<double>& weights)
+    : counts(counts)
+    , weights(weights.empty() ? std::vector<double>(counts.size(), 1.0) : weights)
+{
+    detail::ValidateAndNormalize(this->counts, this->weights);
+};
+
+/**
+ * Calculate the probabilities of each picture being completed first.
+ */
+std::vector<double> RuntimeCrossStitch::Calc() {
+    std::vector<double> result(counts.size(), 0.0);
+    std::vector<int> otherCounts(counts.size() - 1);
+    std::vector<double> otherWeights(counts.size() - 1);
+    for (std::size_t i = 0; i < counts.size(); i++) {
+        for (std::size_t j = 0, other = 0; j < counts.size(); j++) {
+            if (j != i) {
+                otherCounts[other] = counts[j];
+                otherWeights[other] = weights[j];
+                other++;
+            }
+        }
+
+        result[i] = detail::OneSampleProbability(counts[i], weights[i], otherCounts, otherWeights, states, diagonals);
+    }
+
+    return result;
+};
+
+} // namespace crossstitch
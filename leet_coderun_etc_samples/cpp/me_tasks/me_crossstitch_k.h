@@ -0,0 +1,287 @@
+#pragma once
+
+#include <array>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * The generalized kitten stitch task: the cat embroiders K pictures and, when
+ * she wakes up, selects the i-th picture with the probability proportional to
+ * its weight. What is the probability for each picture to be completed first?
+ */
+namespace crossstitch {
+
+namespace detail {
+
+/// The largest number of DP states a single probability may keep in memory (2 GiB of doubles).
+constexpr std::size_t MAX_STATES_COUNT = std::size_t(1) << 28;
+
+/**
+ * Calculate the probability for one picture to be completed first.
+ *
+ * The picture with `count` squares left is completed first if it gets its (count-1)-th
+ * square together with j_i < n_i squares of every other picture, and then the last one:
+ *     C(count-1+t, t) * p^count * (1-p)^t * g(j),   t = sum(j_i),
+ * where g(j) is the probability that a walk over the other pictures only, choosing them
+ * with the weights q_i = p_i / (1-p), passes through the state j. g is filled in the
+ * mixed-radix order of the states, so g(j - e_i) is always ready, and is summed over
+ * the diagonals t.
+ *
+ * The containers are std::array for a compile-time number of pictures, so the loops
+ * over the dimensions unroll, or std::vector for a runtime one.
+ *
+ * A state only depends on its neighbours one step back in every dimension, so only two
+ * hyperplanes of the outermost digit are kept, and the dimension with the largest count
+ * is made the outermost one: the memory is O(product of the other counts / largest of them).
+ *
+ * Pictures with zero weight never get a square, so their dimension is pruned to the
+ * single state j_i = 0. States with probabilities below DBL_MIN are flushed to zero.
+ */
+template <typename TCounts, typename TWeights>
+double OneSampleProbability(
+    const int count,
+    const double weight,
+    const TCounts& otherCounts,
+    const TWeights& otherWeights,
+    std::vector<double>& states,
+    std::vector<double>& diagonals)
+{
+    if (weight <= 0.0) {
+        return 0.0;
+    }
+
+    const double restWeight = 1.0 - weight;
+
+    // Compact state encoding: mixed-radix digits j_i in [0, radix_i)
+    TCounts radix = otherCounts;
+    TCounts strides = otherCounts;
+    TCounts digits = otherCounts;
+    TWeights walkWeights = otherWeights;
+    for (std::size_t i = 0; i < radix.size(); i++) {
+        radix[i] = otherWeights[i] > 0.0 ? otherCounts[i] : 1;
+        digits[i] = 0;
+        walkWeights[i] = restWeight > 0.0 ? otherWeights[i] / restWeight : 0.0;
+    }
+
+    // The outermost digit gets the largest radix, as only two of its hyperplanes are stored
+    std::size_t outer = 0;
+    for (std::size_t i = 1; i < radix.size(); i++) {
+        if (radix[i] > radix[outer]) {
+            outer = i;
+        }
+    }
+
+    std::size_t planeSize = 1;
+    std::size_t maxDiagonal = 0;
+    if (!radix.empty()) {
+        std::swap(radix[outer], radix[radix.size() - 1]);
+        std::swap(walkWeights[outer], walkWeights[radix.size() - 1]);
+        outer = radix.size() - 1;
+
+        for (std::size_t i = 0; i < radix.size(); i++) {
+            strides[i] = static_cast<int>(planeSize);
+            maxDiagonal += radix[i] - 1;
+            if (i != outer) {
+                planeSize *= radix[i];
+                if (2 * planeSize > MAX_STATES_COUNT) {
+                    throw std::length_error("Too many states for the cross stitch DP.");
+                }
+            }
+        }
+    }
+
+    const std::size_t statesCount = radix.empty() ? 1 : planeSize * radix[outer];
+    states.assign(2 * planeSize, 0.0);
+    diagonals.assign(maxDiagonal + 1, 0.0);
+
+    // current is the hyperplane of the current outer digit, previous is the one of the digit before
+    double* current = states.data();
+    double* previous = states.data() + planeSize;
+    std::size_t diagonal = 0;
+    std::size_t local = 0; // index of the state within its hyperplane
+    for (std::size_t index = 0; index < statesCount; index++) {
+        double value = 0.0;
+        if (index == 0) {
+            value = 1.0;
+        } else {
+            for (std::size_t i = 0; i < radix.size(); i++) {
+                if (digits[i] > 0) {
+                    value += walkWeights[i] * (i == outer ? previous[local] : current[local - strides[i]]);
+                }
+            }
+        }
+
+        current[local] = value < DBL_MIN ? 0.0 : value;
+        diagonals[diagonal] += current[local];
+
+        if (++local == planeSize) {
+            local = 0;
+            std::swap(current, previous);
+        }
+
+        // Move to the next state, carrying the digits over
+        for (std::size_t i = 0; i < radix.size(); i++) {
+            if (++digits[i] < radix[i]) {
+                diagonal++;
+                break;
+            }
+
+            diagonal -= digits[i] - 1;
+            digits[i] = 0;
+        }
+    }
+
+    // Weight each diagonal with the probability of the target picture's own squares
+    const double logBase = count * std::log(weight) - std::lgamma(count);
+    const double logRest = restWeight > 0.0 ? std::log(restWeight) : 0.0;
+    double result = 0.0;
+    for (std::size_t t = 0; t < diagonals.size(); t++) {
+        if (diagonals[t] == 0.0) {
+            continue;
+        }
+
+        if (t > 0 && restWeight <= 0.0) {
+            break;
+        }
+
+        const double logWeight = logBase + std::lgamma(count + t) - std::lgamma(t + 1.0) + t * logRest;
+        result += std::exp(logWeight) * diagonals[t];
+    }
+
+    return result;
+}
+
+/**
+ * Check the counts and weights and normalize the weights to sum up to one.
+ */
+template <typename TCounts, typename TWeights>
+void ValidateAndNormalize(const TCounts& counts, TWeights& weights) {
+    if (counts.size() != weights.size() || counts.empty()) {
+        throw std::invalid_argument("There must be one weight for each of one or more pictures.");
+    }
+
+    double total = 0.0;
+    for (std::size_t i = 0; i < counts.size(); i++) {
+        if (counts[i] <= 0) {
+            throw std::invalid_argument("The remaining squares counts must be positive.");
+        }
+
+        if (!(weights[i] >= 0.0) || std::isinf(weights[i])) {
+            throw std::invalid_argument("The selection weights must be finite and non-negative.");
+        }
+
+        total += weights[i];
+    }
+
+    if (total <= 0.0) {
+        throw std::invalid_argument("At least one selection weight must be positive.");
+    }
+
+    for (double& weight : weights) {
+        weight /= total;
+    }
+}
+
+} // namespace detail
+
+/**
+ * A class to calculate the probability of each of K pictures being completed first,
+ * with K known at compile time.
+ *
+ * Time complexity of the i-th probability: O(product of the other counts),
+ * memory complexity: O(that product / the largest of the other counts).
+ */
+template <std::size_t K>
+class CrossStitch {
+    static_assert(K > 0, "There must be at least one picture.");
+
+public:
+    /**
+     * Constructor for CrossStitch.
+     *
+     * @param counts Number of squares remaining to embroider on each picture.
+     * @param weights Selection weights of the pictures, uniform by default. They are normalized.
+     *
+     * @throws std::invalid_argument if any count is not positive or the weights are invalid.
+     */
+    explicit CrossStitch(const std::array<int, K>& counts, const std::array<double, K>& weights = UniformWeights())
+        : counts(counts)
+        , weights(weights)
+    {
+        detail::ValidateAndNormalize(this->counts, this->weights);
+    }
+
+    /**
+     * Calculate the probabilities of each picture being completed first.
+     *
+     * @return An array containing the probabilities for the pictures in the order of the counts.
+     */
+    std::array<double, K> Calc() {
+        std::array<double, K> result {};
+        for (std::size_t i = 0; i < K; i++) {
+            std::array<int, K - 1> otherCounts {};
+            std::array<double, K - 1> otherWeights {};
+            for (std::size_t j = 0, other = 0; j < K; j++) {
+                if (j != i) {
+                    otherCounts[other] = counts[j];
+                    otherWeights[other] = weights[j];
+                    other++;
+                }
+            }
+
+            result[i] = detail::OneSampleProbability(counts[i], weights[i], otherCounts, otherWeights, states, diagonals);
+        }
+
+        return result;
+    }
+
+private:
+    static std::array<double, K> UniformWeights() {
+        std::array<double, K> uniform {};
+        uniform.fill(1.0);
+        return uniform;
+    }
+
+    std::array<int, K> counts; ///< Number of squares remaining for each picture.
+    std::array<double, K> weights; ///< Normalized selection probabilities of the pictures.
+
+    std::vector<double> states; ///< Reused probabilities of two hyperplanes of the states of the other pictures.
+    std::vector<double> diagonals; ///< Reused sums of the state probabilities over sum(j) = t.
+};
+
+/**
+ * A class to calculate the probability of each of K pictures being completed first,
+ * with K known only at runtime. Same algorithm as CrossStitch<K>.
+ */
+class RuntimeCrossStitch {
+public:
+    /**
+     * Constructor for RuntimeCrossStitch.
+     *
+     * @param counts Number of squares remaining to embroider on each picture.
+     * @param weights Selection weights of the pictures, empty for uniform. They are normalized.
+     *
+     * @throws std::invalid_argument if any count is not positive or the weights are invalid.
+     */
+    explicit RuntimeCrossStitch(const std::vector<int>& counts, const std::vector<double>& weights = {});
+
+    /**
+     * Calculate the probabilities of each picture being completed first.
+     *
+     * @return A vector containing the probabilities for the pictures in the order of the counts.
+     */
+    std::vector<double> Calc();
+
+private:
+    std::vector<int> counts; ///< Number of squares remaining for each picture.
+    std::vector<double> weights; ///< Normalized selection probabilities of the pictures.
+
+    std::vector<double> states; ///< Reused probabilities of two hyperplanes of the states of the other pictures.
+    std::vector<double> diagonals; ///< Reused sums of the state probabilities over sum(j) = t.
+};
+
+} // namespace crossstitch
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+#include "me_crossstitch_mc.h"
+
+namespace crossstitch {
+
+namespace {
+
+/// Number of trials simulated with one random stream.
+constexpr std::uint64_t BLOCK_TRIALS = 1 << 16;
+
+/// Number of choices out of three extracted from one 64-bit random value.
+/// Every extraction consumes about 1.6 bits, so 20 keep the choices practically unbiased.
+constexpr int CHOICES_PER_RANDOM = 20;
+
+/**
+ * Counter-based random stream: the i-th value is the SplitMix64 finalizer
+ * applied to key + i * golden gamma, so any stream can be started at any point
+ * without sequential state shared between threads.
+ */
+class CounterRandom {
+public:
+    CounterRandom(const std::uint64_t seed, const std::uint64_t stream)
+        : key(Mix(seed ^ Mix(stream + GOLDEN_GAMMA)))
+    {}
+
+    std::uint64_t Next() {
+        return Mix(key + (++counter) * GOLDEN_GAMMA);
+    }
+
+private:
+    static constexpr std::uint64_t GOLDEN_GAMMA = 0x9e3779b97f4a7c15ULL;
+
+    static std::uint64_t Mix(std::uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    std::uint64_t key = 0;
+    std::uint64_t counter = 0;
+};
+
+/**
+ * Uniform choices from {0, 1, 2}, several per 64-bit random value:
+ * the high word of bits * 3 is the choice and the low word is the rest of the bits.
+ */
+class ChoiceStream {
+public:
+    ChoiceStream(const std::uint64_t seed, const std::uint64_t stream)
+        : random(seed, stream)
+    {}
+
+    int Next() {
+        if (left == 0) {
+            bits = random.Next();
+            left = CHOICES_PER_RANDOM;
+        }
+
+        left--;
+        const unsigned __int128 product = static_cast<unsigned __int128>(bits) * 3;
+        bits = static_cast<std::uint64_t>(product);
+        return static_cast<int>(product >> 64);
+    }
+
+private:
+    CounterRandom random;
+    std::uint64_t bits = 0;
+    int left = 0;
+};
+
+} // namespace
+
+/**
+ * Constructor for MonteCarloCrossStitch.
+ */
+MonteCarloCrossStitch::MonteCarloCrossStitch(const int n, const int m, const int k)
+    : nCount(n)
+    , mCount(m)
+    , kCount(k)
+{
+    if (n <= 0 || m <= 0 || k <= 0) {
+        throw std::invalid_argument("The remaining squares counts must be positive.");
+    }
+};
+
+/**
+ * Simulate the trials of one block and add the wins to the counters.
+ */
+void MonteCarloCrossStitch::SimulateBlock(const std::uint64_t seed, const std::uint64_t block, const std::uint64_t trials, std::uint64_t* wins) const {
+    ChoiceStream choices(seed, block);
+    std::array<std::uint64_t, 3> blockWins = {0, 0, 0};
+    for (std::uint64_t trial = 0; trial < trials; trial++) {
+        std::array<int, 3> remaining = {nCount, mCount, kCount};
+        int picture;
+        do {
+            picture = choices.Next();
+        } while (--remaining[picture] != 0);
+
+        blockWins[picture]++;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        wins[i] += blockWins[i];
+    }
+}
+
+/**
+ * Estimate the probabilities of each picture being completed first.
+ */
+MonteCarloResult MonteCarloCrossStitch::Calc(const std::uint64_t trials, const std::uint64_t seed, unsigned threads, const double z) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    const std::uint64_t blocks = (trials + BLOCK_TRIALS - 1) / BLOCK_TRIALS;
+    threads = static_cast<unsigned>(std::min<std::uint64_t>(threads, std::max<std::uint64_t>(blocks, 1)));
+
+    // Every worker keeps its own counters, padded to separate cache lines.
+    struct alignas(64) WorkerWins {
+        std::uint64_t wins[3] = {0, 0, 0};
+    };
+    std::vector<WorkerWins> workerWins(threads);
+    std::atomic<std::uint64_t> nextBlock {0};
+
+    auto worker = [&](const unsigned index) {
+        for (std::uint64_t block = nextBlock++; block < blocks; block = nextBlock++) {
+            const std::uint64_t blockTrials = std::min(BLOCK_TRIALS, trials - block * BLOCK_TRIALS);
+            SimulateBlock(seed, block, blockTrials, workerWins[index].wins);
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; i++) {
+        workers.emplace_back(worker, i);
+    }
+    worker(0);
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+
+    MonteCarloResult result;
+    result.trials = trials;
+    result.wins.assign(3, 0);
+    for (const WorkerWins& local : workerWins) {
+        for (int i = 0; i < 3; i++) {
+            result.wins[i] += local.wins[i];
+        }
+    }
+
+    // Wilson score interval, which stays inside [0, 1] even for probabilities close to 0 or 1
+    const double total = static_cast<double>(trials);
+    const double z2 = z * z;
+    for (int i = 0; i < 3; i++) {
+        const double p = trials > 0 ? result.wins[i] / total : 0.0;
+        const double denominator = 1.0 + z2 / total;
+        const double center = (p + z2 / (2.0 * total)) / denominator;
+        const double halfWidth = z * std::sqrt(p * (1.0 - p) / total + z2 / (4.0 * total * total)) / denominator;
+
+        result.probabilities.push_back(p);
+        result.lowerBounds.push_back(trials > 0 ? std::max(0.0, center - halfWidth) : 0.0);
+        result.upperBounds.push_back(trials > 0 ? std::min(1.0, center + halfWidth) : 1.0);
+    }
+
+    return result;
+};
+
+} // namespace crossstitch
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * The same kitten stitch task as in me_crossstitch_calc.h, estimated with a
+ * parallel Monte Carlo simulation. It is used to validate the exact engines
+ * and works for any counts, at the cost of O(n + m + k) steps per trial.
+ */
+namespace crossstitch {
+
+/**
+ * The result of a Monte Carlo estimation.
+ */
+struct MonteCarloResult {
+    std::uint64_t trials = 0; ///< Number of simulated trials.
+    std::vector<std::uint64_t> wins; ///< Number of trials won by the fish, bird, and garden pictures.
+    std::vector<double> probabilities; ///< Estimated probabilities for the fish, bird, and garden pictures.
+    std::vector<double> lowerBounds; ///< Lower bounds of the Wilson score confidence intervals.
+    std::vector<double> upperBounds; ///< Upper bounds of the Wilson score confidence intervals.
+};
+
+/**
+ * A class to estimate the probability of each picture being completed first
+ * by simulating the embroidering.
+ *
+ * The trials are split into fixed-size blocks, and every block draws its random
+ * numbers from its own counter-based stream keyed by (seed, block index).
+ * Worker threads take blocks from a shared atomic counter and keep their win
+ * counters local, so the result depends only on the seed and the number of
+ * trials, not on the number of threads or on the scheduling.
+ */
+class MonteCarloCrossStitch {
+public:
+    /**
+     * Constructor for MonteCarloCrossStitch.
+     *
+     * @param n Number of squares remaining to embroider on the fish picture.
+     * @param m Number of squares remaining to embroider on the bird picture.
+     * @param k Number of squares remaining to embroider on the garden picture.
+     *
+     * @throws std::invalid_argument if any of the counts is not positive.
+     */
+    explicit MonteCarloCrossStitch(const int n, const int m, const int k);
+
+    /**
+     * Estimate the probabilities of each picture being completed first.
+     *
+     * @param trials Number of trials to simulate.
+     * @param seed Seed of the random streams.
+     * @param threads Number of worker threads, 0 means std::thread::hardware_concurrency().
+     * @param z The normal quantile of the confidence level (1.96 for 95%).
+     * @return The estimated probabilities with their confidence intervals.
+     */
+    MonteCarloResult Calc(const std::uint64_t trials, const std::uint64_t seed = 0, unsigned threads = 0, const double z = 1.959963984540054);
+
+protected:
+    /**
+     * Simulate the trials of one block and add the wins to the counters.
+     *
+     * @param seed Seed of the random streams.
+     * @param block Index of the block, selects the random stream.
+     * @param trials Number of trials in the block.
+     * @param[out] wins Win counters for the fish, bird, and garden pictures.
+     */
+    void SimulateBlock(const std::uint64_t seed, const std::uint64_t block, const std::uint64_t trials, std::uint64_t* wins) const;
+
+private:
+    int nCount = 0; ///< Number of squares remaining for the fish picture.
+    int mCount = 0; ///< Number of squares remaining for the bird picture.
+    int kCount = 0; ///< Number of squares remaining for the garden picture.
+};
+
+} // namespace crossstitch
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "me_crossstitch_table.h"
+#include "me_crossstitch_dp.h"
+
+namespace crossstitch {
+
+namespace {
+
+constexpr char TABLE_MAGIC[8] = "XSTITCH";
+constexpr std::uint32_t TABLE_VERSION = 1;
+
+/**
+ * Index of the sorted triple 1 <= a <= b <= c in the table.
+ */
+std::uint64_t TripleIndex(const std::uint64_t a, const std::uint64_t b, const std::uint64_t c) {
+    return (c + 1) * c * (c - 1) / 6 + b * (b - 1) / 2 + (a - 1);
+}
+
+} // namespace
+
+/**
+ * Calculate the probabilities for all sorted triples up to maxCount and write them to a file.
+ *
+ * For a pair of other pictures (x, y), S(t) is the probability mass of their states
+ * (j < x, l < y) on the diagonal j + l = t. It serves every sorted triple containing x and y:
+ * (a, x, y) for a <= x, (x, b, y) for x <= b <= y and (x, y, c) for c >= y, and is grown
+ * column by column over y, so it is only ever added to.
+ */
+void GenerateCrossStitchTable(const std::string& path, const int maxCount) {
+    if (maxCount <= 0) {
+        throw std::invalid_argument("The table size must be positive.");
+    }
+
+    const std::size_t size = maxCount;
+    const std::size_t diagonalsCount = 2 * size - 1;
+
+    // States probabilities of the other two pictures: g(j, l) = (g(j-1, l) + g(j, l-1)) / 2
+    std::vector<double> states(size * size, 0.0);
+    for (std::size_t j = 0; j < size; j++) {
+        for (std::size_t l = 0; l < size; l++) {
+            double value = 1.0;
+            if (j > 0 || l > 0) {
+                value = 0.5 * ((j > 0 ? states[(j - 1) * size + l] : 0.0) + (l > 0 ? states[j * size + l - 1] : 0.0));
+            }
+            states[j * size + l] = value < DBL_MIN ? 0.0 : value;
+        }
+    }
+
+    // Weights of the diagonals for the target picture with a squares left: C(a-1+t, t) * 3^-a * (2/3)^t
+    std::vector<double> weights((size + 1) * diagonalsCount, 0.0);
+    for (std::size_t a = 1; a <= size; a++) {
+        for (std::size_t t = 0; t < diagonalsCount; t++) {
+            const double logWeight = std::lgamma(a + t) - std::lgamma(a) - std::lgamma(t + 1.0)
+                - a * std::log(3.0) + t * std::log(2.0 / 3.0);
+            weights[a * diagonalsCount + t] = std::exp(logWeight);
+        }
+    }
+
+    auto probability = [&](const std::size_t a, const std::vector<double>& diagonalSums, const std::size_t diagonals) {
+        const double* weight = weights.data() + a * diagonalsCount;
+        double result = 0.0;
+        for (std::size_t t = 0; t < diagonals; t++) {
+            result += weight[t] * diagonalSums[t];
+        }
+        return result;
+    };
+
+    CrossStitchTableHeader header {};
+    std::memcpy(header.magic, TABLE_MAGIC, sizeof(header.magic));
+    header.version = TABLE_VERSION;
+    header.maxCount = maxCount;
+    header.entriesCount = TripleIndex(1, 1, size + 1);
+
+    std::vector<double> table(3 * header.entriesCount, 0.0);
+    std::vector<double> diagonalSums(diagonalsCount, 0.0);
+    for (std::size_t x = 1; x <= size; x++) {
+        std::fill(diagonalSums.begin(), diagonalSums.end(), 0.0);
+        for (std::size_t y = 1; y <= size; y++) {
+            // Add the column l = y - 1 of the states j < x
+            for (std::size_t j = 0; j < x; j++) {
+                diagonalSums[j + y - 1] += states[j * size + y - 1];
+            }
+
+            if (y < x) {
+                continue;
+            }
+
+            const std::size_t diagonals = x + y - 1;
+            for (std::size_t a = 1; a <= x; a++) {
+                table[3 * TripleIndex(a, x, y)] = probability(a, diagonalSums, diagonals);
+            }
+            for (std::size_t b = x; b <= y; b++) {
+                table[3 * TripleIndex(x, b, y) + 1] = probability(b, diagonalSums, diagonals);
+            }
+            for (std::size_t c = y; c <= size; c++) {
+                table[3 * TripleIndex(x, y, c) + 2] = probability(c, diagonalSums, diagonals);
+            }
+        }
+    }
+
+    std::ofstream output(path, std::ios::binary | std::ios::trunc);
+    output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(double));
+    if (!output) {
+        throw std::runtime_error("Can't write the cross stitch table: " + path);
+    }
+};
+
+/**
+ * Maps the table file into memory and checks its header.
+ */
+CrossStitchTable::CrossStitchTable(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Can't open the cross stitch table: " + path);
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || static_cast<std::size_t>(fileStat.st_size) < sizeof(CrossStitchTableHeader)) {
+        close(fd);
+        throw std::runtime_error("The cross stitch table is too short: " + path);
+    }
+
+    mappingSize = fileStat.st_size;
+    mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        throw std::runtime_error("Can't map the cross stitch table: " + path);
+    }
+
+    const auto* header = static_cast<const CrossStitchTableHeader*>(mapping);
+    const bool valid = std::memcmp(header->magic, TABLE_MAGIC, sizeof(header->magic)) == 0
+        && header->version == TABLE_VERSION
+        && header->maxCount > 0
+        && header->entriesCount == TripleIndex(1, 1, std::uint64_t(header->maxCount) + 1)
+        && mappingSize == sizeof(CrossStitchTableHeader) + 3 * header->entriesCount * sizeof(double);
+
+    if (!valid) {
+        munmap(mapping, mappingSize);
+        mapping = nullptr;
+        throw std::runtime_error("Invalid cross stitch table: " + path);
+    }
+
+    maxCount = header->maxCount;
+    probabilities = reinterpret_cast<const double*>(static_cast<const char*>(mapping) + sizeof(CrossStitchTableHeader));
+};
+
+CrossStitchTable::~CrossStitchTable() {
+    if (mapping != nullptr) {
+        munmap(mapping, mappingSize);
+    }
+};
+
+/**
+ * Look the probabilities up in the table, permuting the counts into the sorted order and back.
+ */
+bool CrossStitchTable::Lookup(const int n, const int m, const int k, double* result) const {
+    const int counts[3] = {n, m, k};
+    int order[3] = {0, 1, 2};
+    std::sort(order, order + 3, [&counts](const int lhs, const int rhs) { return counts[lhs] < counts[rhs]; });
+
+    if (counts[order[0]] < 1 || counts[order[2]] > maxCount) {
+        return false;
+    }
+
+    const double* entry = probabilities + 3 * TripleIndex(counts[order[0]], counts[order[1]], counts[order[2]]);
+    for (int i = 0; i < 3; i++) {
+        result[order[i]] = entry[i];
+    }
+
+    return true;
+};
+
+/**
+ * Calculate the probabilities of each picture being completed first.
+ */
+std::vector<double> CrossStitchTable::Calc(const int n, const int m, const int k) const {
+    std::vector<double> result(3, 0.0);
+    if (Lookup(n, m, k, result.data())) {
+        return result;
+    }
+
+    DpCrossStitch cross(n, m, k);
+    return cross.Calc();
+};
+
+int CrossStitchTable::GetMaxCount() const {
+    return maxCount;
+};
+
+} // namespace crossstitch
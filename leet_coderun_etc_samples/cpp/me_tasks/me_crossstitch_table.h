@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * A precomputed answer table for the kitten stitch task (see me_crossstitch_calc.h).
+ *
+ * The answer is symmetric under permutations of (n, m, k), so the table only stores
+ * the sorted triples 1 <= a <= b <= c <= maxCount, three doubles each, in the order of
+ * the index C(c+1, 3) + C(b, 2) + a - 1. The file is a CrossStitchTableHeader followed
+ * by the probabilities.
+ */
+namespace crossstitch {
+
+/**
+ * The header of a precomputed table file.
+ */
+struct CrossStitchTableHeader {
+    char magic[8]; ///< Always "XSTITCH".
+    std::uint32_t version; ///< Format version, currently 1.
+    std::uint32_t maxCount; ///< The largest count stored in the table.
+    std::uint64_t entriesCount; ///< Number of stored sorted triples.
+};
+
+/**
+ * Calculate the probabilities for all sorted triples up to maxCount and write them to a file.
+ *
+ * All the triples share the state probabilities of the DP engine (see me_crossstitch_dp.h).
+ * For every pair of the other two counts (x, y) the diagonal sums of the states j < x, l < y
+ * are extended by one column at a time, and every probability using them costs O(maxCount),
+ * so generating the whole table costs O(maxCount^4) time and O(maxCount^2) memory
+ * besides the table itself.
+ *
+ * @param path The path of the table file to write.
+ * @param maxCount The largest count to store.
+ *
+ * @throws std::invalid_argument if maxCount is not positive.
+ * @throws std::runtime_error if the file can't be written.
+ */
+void GenerateCrossStitchTable(const std::string& path, const int maxCount);
+
+/**
+ * A class to answer cross stitch queries from a memory-mapped precomputed table,
+ * falling back to DpCrossStitch for the counts outside of the table.
+ */
+class CrossStitchTable {
+public:
+    /**
+     * Maps the table file into memory.
+     *
+     * @param path The path of a file written by GenerateCrossStitchTable.
+     *
+     * @throws std::runtime_error if the file can't be mapped or is not a valid table.
+     */
+    explicit CrossStitchTable(const std::string& path);
+    ~CrossStitchTable();
+
+    CrossStitchTable(const CrossStitchTable&) = delete;
+    CrossStitchTable& operator=(const CrossStitchTable&) = delete;
+
+    /**
+     * Look the probabilities up in the table.
+     *
+     * @param[out] result The probabilities for the fish, bird, and garden pictures, respectively.
+     * @return false if the counts are outside of the table.
+     */
+    bool Lookup(const int n, const int m, const int k, double* result) const;
+
+    /**
+     * Calculate the probabilities of each picture being completed first.
+     *
+     * @return A vector containing the probabilities for the fish, bird, and garden pictures, respectively.
+     */
+    std::vector<double> Calc(const int n, const int m, const int k) const;
+
+    /**
+     * The largest count stored in the table.
+     */
+    int GetMaxCount() const;
+
+private:
+    void* mapping = nullptr; ///< The whole mapped file.
+    std::size_t mappingSize = 0; ///< Size of the mapped file in bytes.
+    const double* probabilities = nullptr; ///< The stored probabilities, right after the header.
+    int maxCount = 0; ///< The largest count stored in the table.
+};
+
+} // namespace crossstitch
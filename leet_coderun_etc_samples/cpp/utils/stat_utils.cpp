@@ -1,9 +1,89 @@
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
+#include <limits>
 #include <stdexcept>
 #include "stat_utils.h"
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define STAT_UTILS_X86 1
+#endif
+
 namespace stat_utils {
+
+/// ln(n!) is tabulated up to this n, larger values are computed with std::lgamma.
+constexpr std::uint64_t LOG_FACTORIAL_TABLE_MAX_N = 1 << 20;
+
+namespace {
+
+/**
+ * Looks C(n[i], k[i]) up in the compile-time table; pairs outside of it get the placeholder 0.
+ *
+ * @return true if any n[i] is outside of the table.
+ */
+bool SmallCombinationsBatchScalar(const std::uint64_t* n, const std::uint64_t* k, std::uint64_t* result, const std::size_t count) {
+    bool hasLarge = false;
+    for (std::size_t i = 0; i < count; i++) {
+        const bool small = n[i] <= SMALL_BINOMIAL_MAX_N;
+        const bool valid = k[i] <= n[i];
+        result[i] = (small && valid) ? detail::SMALL_BINOMIAL_TABLE[detail::TriangleIndex(n[i], k[i])] : 0;
+        hasLarge |= !small;
+    }
+
+    return hasLarge;
+}
+
+#ifdef STAT_UTILS_X86
+
+/**
+ * AVX2 version of SmallCombinationsBatchScalar: 4 pairs per step, looked up with a masked gather.
+ * AVX2 has only signed 64-bit compares, so the values are first checked to be below 128 by a shift.
+ */
+__attribute__((target("avx2")))
+bool SmallCombinationsBatchAvx2(const std::uint64_t* n, const std::uint64_t* k, std::uint64_t* result, const std::size_t count) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i tableSize = _mm256_set1_epi64x(SMALL_BINOMIAL_MAX_N + 1);
+    const long long* table = reinterpret_cast<const long long*>(detail::SMALL_BINOMIAL_TABLE.data());
+
+    __m256i large = zero;
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m256i nVector = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(n + i));
+        const __m256i kVector = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(k + i));
+
+        const __m256i nBelow128 = _mm256_cmpeq_epi64(_mm256_srli_epi64(nVector, 7), zero);
+        const __m256i kBelow128 = _mm256_cmpeq_epi64(_mm256_srli_epi64(kVector, 7), zero);
+        const __m256i small = _mm256_and_si256(nBelow128, _mm256_cmpgt_epi64(tableSize, nVector));
+        const __m256i valid = _mm256_andnot_si256(_mm256_cmpgt_epi64(kVector, nVector), _mm256_and_si256(small, kBelow128));
+
+        // TriangleIndex(n, k) = n * (n + 1) / 2 + k; n < 128, so the 32-bit multiply is exact
+        const __m256i index = _mm256_and_si256(valid, _mm256_add_epi64(
+            _mm256_srli_epi64(_mm256_mul_epu32(nVector, _mm256_add_epi64(nVector, one)), 1), kVector));
+        const __m256i values = _mm256_mask_i64gather_epi64(zero, table, index, valid, 8);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(result + i), values);
+        large = _mm256_or_si256(large, _mm256_xor_si256(small, _mm256_cmpeq_epi64(zero, zero)));
+    }
+
+    const bool hasLarge = !_mm256_testz_si256(large, large);
+    return SmallCombinationsBatchScalar(n + i, k + i, result + i, count - i) || hasLarge;
+}
+
+bool HasAvx2() {
+    static const bool avx2 = []() {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    }();
+
+    return avx2;
+}
+
+#endif // STAT_UTILS_X86
+
+} // namespace
+
 /**
  * Calculates the binomial coefficient C(n, k) - the number
  * of combinations "n choose k" (C(n,k) = n! / (k! * (n-k)!))
@@ -53,4 +133,178 @@ std::uint64_t TotalCombinationsN(const std::uint64_t n) {
     return std::pow(3, n);
 };
 
+/**
+ * Extends the 128-bit Pascal triangle up to the row n (n <= EXACT_BINOMIAL_MAX_N).
+ */
+void BinomialTable::GrowExactTable(const std::uint64_t n) {
+    const std::size_t firstIndex = detail::TriangleIndex(SMALL_BINOMIAL_MAX_N + 1, 0);
+    exactRows.resize(detail::TriangleIndex(n + 1, 0) - firstIndex);
+
+    for (std::uint64_t row = exactMaxN + 1; row <= n; row++) {
+        UInt128* current = exactRows.data() + detail::TriangleIndex(row, 0) - firstIndex;
+        current[0] = 1;
+        current[row] = 1;
+        for (std::uint64_t k = 1; k < row; k++) {
+            if (row - 1 <= SMALL_BINOMIAL_MAX_N) {
+                current[k] = static_cast<UInt128>(SmallCombinationsKN(row - 1, k - 1)) + SmallCombinationsKN(row - 1, k);
+            } else {
+                const UInt128* previous = exactRows.data() + detail::TriangleIndex(row - 1, 0) - firstIndex;
+                current[k] = previous[k - 1] + previous[k];
+            }
+        }
+    }
+
+    exactMaxN = n;
+}
+
+/**
+ * Extends the log-factorial table to cover at least n (n <= LOG_FACTORIAL_TABLE_MAX_N).
+ * The table at least doubles, so a sequence of growing requests costs amortized O(1) each.
+ */
+void BinomialTable::GrowLogFactorialTable(const std::uint64_t n) {
+    const std::size_t newSize = std::min<std::uint64_t>(
+        std::max<std::uint64_t>(n + 1, 2 * logFactorials.size()),
+        LOG_FACTORIAL_TABLE_MAX_N + 1);
+
+    if (logFactorials.empty()) {
+        logFactorials.push_back(0.0);
+    }
+
+    // A running sum of logarithms would accumulate the rounding errors, so every entry is computed directly
+    logFactorials.reserve(newSize);
+    for (std::size_t i = logFactorials.size(); i < newSize; i++) {
+        logFactorials.push_back(std::lgamma(static_cast<double>(i) + 1.0));
+    }
+}
+
+/**
+ * Calculates C(n, k) exactly if it fits into 128 bits.
+ *
+ * @note For n > EXACT_BINOMIAL_MAX_N the multiplicative formula is used, and it is
+ *       reported as an overflow if the intermediate product res * (n - i + 1) does not fit,
+ *       even though the final result might.
+ */
+bool BinomialTable::TryCombinations(const std::uint64_t n, const std::uint64_t k, UInt128& result) {
+    if (k > n) {
+        result = 0;
+        return true;
+    }
+
+    if (n <= SMALL_BINOMIAL_MAX_N) {
+        result = SmallCombinationsKN(n, k);
+        return true;
+    }
+
+    if (n <= EXACT_BINOMIAL_MAX_N) {
+        if (n > exactMaxN) {
+            GrowExactTable(n);
+        }
+
+        result = exactRows[detail::TriangleIndex(n, k) - detail::TriangleIndex(SMALL_BINOMIAL_MAX_N + 1, 0)];
+        return true;
+    }
+
+    // Same iterative approach as in CombinationsKN, but checked and in 128 bits
+    const std::uint64_t effective_k = (k > n - k) ? n - k : k;
+    constexpr UInt128 maxValue = std::numeric_limits<UInt128>::max();
+    UInt128 res = 1;
+    for (std::uint64_t i = 1; i <= effective_k; i++) {
+        const std::uint64_t factor = n - i + 1;
+        if (res > maxValue / factor) {
+            return false;
+        }
+
+        res = res * factor / i;
+    }
+
+    result = res;
+    return true;
+}
+
+/**
+ * Calculates C(n, k) as a 64-bit value.
+ */
+std::uint64_t BinomialTable::Combinations(const std::uint64_t n, const std::uint64_t k) {
+    if (n <= SMALL_BINOMIAL_MAX_N) {
+        return SmallCombinationsKN(n, k);
+    }
+
+    UInt128 result = 0;
+    if (!TryCombinations(n, k, result) || result > std::numeric_limits<std::uint64_t>::max()) {
+        throw std::overflow_error("C(n, k) is too large for a 64-bit result.");
+    }
+
+    return static_cast<std::uint64_t>(result);
+}
+
+/**
+ * Calculates ln(n!).
+ */
+double BinomialTable::LogFactorial(const std::uint64_t n) {
+    if (n > LOG_FACTORIAL_TABLE_MAX_N) {
+        return std::lgamma(static_cast<double>(n) + 1.0);
+    }
+
+    if (n >= logFactorials.size()) {
+        GrowLogFactorialTable(n);
+    }
+
+    return logFactorials[n];
+}
+
+/**
+ * Calculates ln C(n, k) = ln(n!) - ln(k!) - ln((n-k)!).
+ */
+double BinomialTable::LogCombinations(const std::uint64_t n, const std::uint64_t k) {
+    if (k > n) {
+        return -std::numeric_limits<double>::infinity();
+    }
+
+    return LogFactorial(n) - LogFactorial(k) - LogFactorial(n - k);
+}
+
+/**
+ * Calculates C(n[i], k[i]) for count pairs.
+ */
+void BinomialTable::CombinationsBatch(const std::uint64_t* n, const std::uint64_t* k, std::uint64_t* result, const std::size_t count) {
+    // The pass over the compile-time table is gathered with AVX2 on x86 CPUs supporting it.
+    // Pairs outside of the table get the placeholder 0 and are resolved by the second pass.
+#ifdef STAT_UTILS_X86
+    const bool hasLarge = HasAvx2()
+        ? SmallCombinationsBatchAvx2(n, k, result, count)
+        : SmallCombinationsBatchScalar(n, k, result, count);
+#else
+    const bool hasLarge = SmallCombinationsBatchScalar(n, k, result, count);
+#endif
+
+    if (!hasLarge) {
+        return;
+    }
+
+    for (std::size_t i = 0; i < count; i++) {
+        if (n[i] > SMALL_BINOMIAL_MAX_N) {
+            result[i] = Combinations(n[i], k[i]);
+        }
+    }
+}
+
+/**
+ * Calculates ln C(n[i], k[i]) for count pairs.
+ */
+void BinomialTable::LogCombinationsBatch(const std::uint64_t* n, const std::uint64_t* k, double* result, const std::size_t count) {
+    // Grow the table once for the whole batch, so the main loop is pure lookups.
+    std::uint64_t maxN = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        maxN = std::max(maxN, n[i]);
+    }
+
+    if (maxN <= LOG_FACTORIAL_TABLE_MAX_N && maxN >= logFactorials.size()) {
+        GrowLogFactorialTable(maxN);
+    }
+
+    for (std::size_t i = 0; i < count; i++) {
+        result[i] = LogCombinations(n[i], k[i]);
+    }
+}
+
 } // namespace stat_utils
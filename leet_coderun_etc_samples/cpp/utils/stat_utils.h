@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 namespace stat_utils {
@@ -7,4 +10,113 @@ namespace stat_utils {
 std::uint64_t CombinationsKN(const std::uint64_t n, const std::uint64_t k);
 std::uint64_t TotalCombinationsN(const std::uint64_t n);
 
-} // namespace stat_utils
\ No newline at end of file
+using UInt128 = unsigned __int128;
+
+/// The largest n for which every C(n, k) fits into 64 bits (C(68, 34) does not).
+constexpr std::uint64_t SMALL_BINOMIAL_MAX_N = 67;
+
+/// The largest n for which every C(n, k) fits into 128 bits (C(132, 66) does not).
+constexpr std::uint64_t EXACT_BINOMIAL_MAX_N = 131;
+
+namespace detail {
+
+/// Index of C(n, k) in a Pascal triangle stored row by row.
+constexpr std::size_t TriangleIndex(const std::uint64_t n, const std::uint64_t k) {
+    return n * (n + 1) / 2 + k;
+}
+
+constexpr std::size_t SMALL_BINOMIAL_TABLE_SIZE = TriangleIndex(SMALL_BINOMIAL_MAX_N + 1, 0);
+
+constexpr std::array<std::uint64_t, SMALL_BINOMIAL_TABLE_SIZE> BuildSmallBinomialTable() {
+    std::array<std::uint64_t, SMALL_BINOMIAL_TABLE_SIZE> table {};
+    for (std::uint64_t n = 0; n <= SMALL_BINOMIAL_MAX_N; n++) {
+        table[TriangleIndex(n, 0)] = 1;
+        table[TriangleIndex(n, n)] = 1;
+        for (std::uint64_t k = 1; k < n; k++) {
+            table[TriangleIndex(n, k)] = table[TriangleIndex(n - 1, k - 1)] + table[TriangleIndex(n - 1, k)];
+        }
+    }
+
+    return table;
+}
+
+/// Pascal triangle for n <= SMALL_BINOMIAL_MAX_N, built at compile time.
+inline constexpr std::array<std::uint64_t, SMALL_BINOMIAL_TABLE_SIZE> SMALL_BINOMIAL_TABLE = BuildSmallBinomialTable();
+
+} // namespace detail
+
+/**
+ * Compile-time binomial coefficient C(n, k) for n <= SMALL_BINOMIAL_MAX_N.
+ *
+ * @return C(n, k), or 0 if k > n
+ */
+constexpr std::uint64_t SmallCombinationsKN(const std::uint64_t n, const std::uint64_t k) {
+    return k > n ? 0 : detail::SMALL_BINOMIAL_TABLE[detail::TriangleIndex(n, k)];
+}
+
+/**
+ * Binomial coefficient provider backed by precomputed tables.
+ *
+ * - n <= SMALL_BINOMIAL_MAX_N: the compile-time Pascal triangle;
+ * - n <= EXACT_BINOMIAL_MAX_N: a 128-bit Pascal triangle grown lazily up to the largest requested n;
+ * - larger n: an overflow-checked 128-bit multiplicative formula.
+ * Logarithms of the coefficients come from a lazily grown log-factorial table.
+ *
+ * The table grows on const-less calls, so one instance must not be shared between threads.
+ */
+class BinomialTable {
+public:
+    /**
+     * Calculates C(n, k) exactly if it fits into 128 bits.
+     *
+     * @param[out] result C(n, k), or 0 if k > n
+     * @return false if C(n, k) (or, for n > EXACT_BINOMIAL_MAX_N, an intermediate product) overflows 128 bits
+     */
+    bool TryCombinations(const std::uint64_t n, const std::uint64_t k, UInt128& result);
+
+    /**
+     * Calculates C(n, k).
+     *
+     * @return C(n, k), or 0 if k > n
+     * @throws std::overflow_error if the result does not fit into 64 bits
+     */
+    std::uint64_t Combinations(const std::uint64_t n, const std::uint64_t k);
+
+    /**
+     * Calculates ln(n!).
+     */
+    double LogFactorial(const std::uint64_t n);
+
+    /**
+     * Calculates ln C(n, k), suitable for any n.
+     *
+     * @return ln C(n, k), or -infinity if k > n
+     */
+    double LogCombinations(const std::uint64_t n, const std::uint64_t k);
+
+    /**
+     * Calculates C(n[i], k[i]) for count pairs. Pairs inside the compile-time table
+     * are looked up with AVX2 gathers (selected at runtime, scalar otherwise), the rest one by one.
+     *
+     * @throws std::overflow_error if any result does not fit into 64 bits
+     */
+    void CombinationsBatch(const std::uint64_t* n, const std::uint64_t* k, std::uint64_t* result, const std::size_t count);
+
+    /**
+     * Calculates ln C(n[i], k[i]) for count pairs.
+     */
+    void LogCombinationsBatch(const std::uint64_t* n, const std::uint64_t* k, double* result, const std::size_t count);
+
+private:
+    void GrowExactTable(const std::uint64_t n);
+    void GrowLogFactorialTable(const std::uint64_t n);
+
+    /// Rows SMALL_BINOMIAL_MAX_N + 1 .. exactMaxN of the Pascal triangle.
+    std::vector<UInt128> exactRows;
+    std::uint64_t exactMaxN = SMALL_BINOMIAL_MAX_N;
+
+    /// ln(i!) for i < logFactorials.size().
+    std::vector<double> logFactorials;
+};
+
+} // namespace stat_utils
@@ -0,0 +1,281 @@
+#include <opencv2/opencv.hpp>
+#include <opencv2/imgproc.hpp>
+#include <onnxruntime_cxx_api.h>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <utility>
+
+#include "detector.h"
+
+namespace NTestTracker {
+
+// Model and Inference Constants
+// The input image size (width and height) required by the ONNX model.
+constexpr int64_t IMAGE_SIZE_FOR_ONNX = 640;
+
+// The number of values describing one detection: [x_left, y_top, x_right, y_bottom, confidence, class_id].
+constexpr int64_t DETECTION_SIZE = 6;
+
+namespace {
+
+// ONNX Runtime recommends a single environment per process, shared by all sessions.
+Ort::Env& GetOrtEnv() {
+    static Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "YOLOv8-Tracker");
+    return env;
+}
+
+}  // namespace
+
+std::string GetOnnxRuntimeVersion() {
+    return OrtGetApiBase()->GetVersionString();
+}
+
+struct TDetectorModel {
+    TDetectorModel(const std::string& model, const TDetectorOptions& options)
+        : Options(options)
+        , Session(nullptr)
+    {
+        // Ensure the model file exists before attempting to load it.
+        if (!std::filesystem::exists(model)) {
+            throw std::invalid_argument("The model was not found: " + model);
+        }
+
+        Ort::SessionOptions sessionOptions;
+        sessionOptions.SetIntraOpNumThreads(Options.IntraOpNumThreads);
+        sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+        Session = Ort::Session(GetOrtEnv(), model.c_str(), sessionOptions);
+
+        // Get the model's input and output layer names dynamically.
+        Ort::AllocatorWithDefaultOptions allocator;
+        InputName = Session.GetInputNameAllocated(0, allocator).get();
+        OutputName = Session.GetOutputNameAllocated(0, allocator).get();
+
+        // If the output shape is static, the workers bind preallocated output tensors,
+        // otherwise ONNX Runtime allocates the output on every call.
+        OutputShape = Session.GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+        StaticOutputShape = std::all_of(
+            OutputShape.begin(), OutputShape.end(), [](int64_t dim) { return dim > 0; });
+    }
+
+    const TDetectorOptions Options;
+
+    // Session::Run() is thread-safe, so all the workers run the same session concurrently.
+    Ort::Session Session;
+    std::string InputName;
+    std::string OutputName;
+
+    std::vector<int64_t> OutputShape; // as declared by the model
+    bool StaticOutputShape = false;
+};
+
+class TDetectorWorker::TImpl {
+public:
+    explicit TImpl(std::shared_ptr<TDetectorModel> model)
+        : Model(std::move(model))
+        , InputTensor(nullptr)
+        , OutputTensor(nullptr)
+    {
+        // The input tensor is a view over InputTensorValues, so it is created only once.
+        const auto memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+        InputTensorValues.resize(3 * IMAGE_SIZE_FOR_ONNX * IMAGE_SIZE_FOR_ONNX);
+        InputTensor = Ort::Value::CreateTensor<float>(
+            memoryInfo,
+            InputTensorValues.data(),
+            InputTensorValues.size(),
+            InputShape.data(),
+            InputShape.size()
+        );
+
+        // cv::split() writes straight into the tensor planes through these headers (NCHW layout).
+        for (int c = 0; c < 3; ++c) {
+            InputChannels[c] = cv::Mat(
+                IMAGE_SIZE_FOR_ONNX,
+                IMAGE_SIZE_FOR_ONNX,
+                CV_32F,
+                InputTensorValues.data() + c * IMAGE_SIZE_FOR_ONNX * IMAGE_SIZE_FOR_ONNX
+            );
+        }
+
+        if (Model->StaticOutputShape) {
+            size_t outputSize = 1;
+            for (const int64_t dim : Model->OutputShape) {
+                outputSize *= static_cast<size_t>(dim);
+            }
+
+            OutputTensorValues.resize(outputSize);
+            OutputTensor = Ort::Value::CreateTensor<float>(
+                memoryInfo,
+                OutputTensorValues.data(),
+                OutputTensorValues.size(),
+                Model->OutputShape.data(),
+                Model->OutputShape.size()
+            );
+        }
+    }
+
+    TDetectionsView Detect(const cv::Mat& frame) {
+        if (frame.empty()) {
+            throw std::runtime_error("Cannot run detection on an empty frame.");
+        }
+
+        // The model requires a 640x640 RGB image, normalized to [0, 1], in NCHW format.
+        cv::resize(frame, ResizedFrame, cv::Size(IMAGE_SIZE_FOR_ONNX, IMAGE_SIZE_FOR_ONNX));
+        cv::cvtColor(ResizedFrame, RgbFrame, cv::COLOR_BGR2RGB);
+        RgbFrame.convertTo(FloatRgbFrame, CV_32F, 1.0 / 255.0);
+        cv::split(FloatRgbFrame, InputChannels);
+
+        const char* inputNames[] = {Model->InputName.c_str()};
+        const char* outputNames[] = {Model->OutputName.c_str()};
+
+        const float* outputData = nullptr;
+        if (Model->StaticOutputShape) {
+            Model->Session.Run(Ort::RunOptions{nullptr}, inputNames, &InputTensor, 1, outputNames, &OutputTensor, 1);
+            outputData = OutputTensorValues.data();
+            LastOutputShape = Model->OutputShape;
+        } else {
+            auto outputTensors = Model->Session.Run(Ort::RunOptions{nullptr}, inputNames, &InputTensor, 1, outputNames, 1);
+            DynamicOutput = std::move(outputTensors[0]);
+            outputData = DynamicOutput.GetTensorData<float>();
+            LastOutputShape = DynamicOutput.GetTensorTypeAndShapeInfo().GetShape();
+        }
+
+        const int64_t numDetections = LastOutputShape[1];
+        const int64_t detectionSize = LastOutputShape[2];
+        if (detectionSize < DETECTION_SIZE) {
+            throw std::runtime_error("Unexpected model output: " + std::to_string(detectionSize) + " values per detection");
+        }
+
+        ParseDetections(outputData, numDetections, detectionSize, frame.cols, frame.rows);
+        return TDetectionsView(Detections.data(), Detections.size());
+    }
+
+    const std::vector<int64_t>& GetLastOutputShape() const {
+        return LastOutputShape;
+    }
+
+private:
+    // The model output is expected to be already post-processed with NMS.
+    // The format is [x_left, y_top, x_right, y_bottom, confidence, class_id] for each detection
+    void ParseDetections(const float* outputData, int64_t numDetections, int64_t detectionSize, int cols, int rows) {
+        Detections.clear();
+
+        // Scaling factors to map detections from the model's input size (640x640) back to the original frame size.
+        const float xScale = static_cast<float>(cols) / IMAGE_SIZE_FOR_ONNX;
+        const float yScale = static_cast<float>(rows) / IMAGE_SIZE_FOR_ONNX;
+
+        for (int64_t i = 0; i < numDetections; ++i) {
+            const float* detection = outputData + i * detectionSize;
+            const float confidence = detection[4];
+            const int classId = static_cast<int>(detection[5]);
+
+            // Filter out low-confidence detections and invalid classes.
+            if (confidence < Model->Options.ConfThreshold || classId < 0 || classId >= Model->Options.NumClasses) {
+                continue;
+            }
+
+            // Scale bounding box coordinates and clamp them to the frame boundaries.
+            const int left = std::clamp(static_cast<int>(detection[0] * xScale), 0, cols - 1);
+            const int top = std::clamp(static_cast<int>(detection[1] * yScale), 0, rows - 1);
+            const int right = std::clamp(static_cast<int>(detection[2] * xScale), 0, cols);
+            const int bottom = std::clamp(static_cast<int>(detection[3] * yScale), 0, rows);
+
+            if (right <= left || bottom <= top) {
+                continue; // Skip invalid boxes with zero or negative area.
+            }
+
+            Detections.push_back({cv::Rect(left, top, right - left, bottom - top), confidence, classId});
+        }
+    }
+
+private:
+    const std::shared_ptr<TDetectorModel> Model;
+
+    // Inference buffers, reused between calls
+    const std::vector<int64_t> InputShape = {1, 3, IMAGE_SIZE_FOR_ONNX, IMAGE_SIZE_FOR_ONNX};
+    std::vector<float> InputTensorValues;
+    Ort::Value InputTensor;
+    cv::Mat InputChannels[3]; // headers over the planes of InputTensorValues
+
+    std::vector<float> OutputTensorValues; // used only for a static output shape
+    Ort::Value OutputTensor;
+    Ort::Value DynamicOutput {nullptr}; // keeps the last dynamically allocated output alive
+    std::vector<int64_t> LastOutputShape;
+
+    // Preprocessing buffers
+    cv::Mat ResizedFrame;
+    cv::Mat RgbFrame;
+    cv::Mat FloatRgbFrame; // CV_32FC3
+
+    std::vector<TDetection> Detections;
+};
+
+TDetectorWorker::TDetectorWorker(std::shared_ptr<TDetectorModel> model)
+    : Impl(std::make_unique<TImpl>(std::move(model)))
+{}
+
+TDetectorWorker::~TDetectorWorker() = default;
+TDetectorWorker::TDetectorWorker(TDetectorWorker&&) noexcept = default;
+TDetectorWorker& TDetectorWorker::operator=(TDetectorWorker&&) noexcept = default;
+
+TDetectionsView TDetectorWorker::Detect(const cv::Mat& frame) {
+    return Impl->Detect(frame);
+}
+
+void TDetectorWorker::DetectBatch(const std::vector<cv::Mat>& frames, std::vector<std::vector<TDetection>>& results) {
+    // The model takes a batch of one, so frames are run one by one through the worker buffers.
+    results.resize(frames.size());
+    for (size_t i = 0; i < frames.size(); ++i) {
+        const TDetectionsView detections = Impl->Detect(frames[i]);
+        results[i].assign(detections.begin(), detections.end());
+    }
+}
+
+const std::vector<int64_t>& TDetectorWorker::GetLastOutputShape() const {
+    return Impl->GetLastOutputShape();
+}
+
+TDetector::TDetector(const std::string& model, const TDetectorOptions& options)
+    : Model(std::make_shared<TDetectorModel>(model, options))
+    , Worker(Model)
+{}
+
+TDetector::~TDetector() = default;
+TDetector::TDetector(TDetector&&) noexcept = default;
+TDetector& TDetector::operator=(TDetector&&) noexcept = default;
+
+TDetectorWorker TDetector::CreateWorker() const {
+    return TDetectorWorker(Model);
+}
+
+TDetectionsView TDetector::Detect(const cv::Mat& frame) {
+    return Worker.Detect(frame);
+}
+
+void TDetector::DetectBatch(const std::vector<cv::Mat>& frames, std::vector<std::vector<TDetection>>& results) {
+    Worker.DetectBatch(frames, results);
+}
+
+size_t TDetector::DetectStream(cv::VideoCapture& video, const TFrameCallback& callback) {
+    cv::Mat frame;
+    size_t frameIndex = 0;
+    while (video.read(frame) && !frame.empty()) {
+        const TDetectionsView detections = Worker.Detect(frame);
+        ++frameIndex;
+        if (!callback(frameIndex - 1, frame, detections)) {
+            break;
+        }
+    }
+
+    return frameIndex;
+}
+
+const std::vector<int64_t>& TDetector::GetOutputShape() const {
+    return Model->OutputShape;
+}
+
+const std::vector<int64_t>& TDetector::GetLastOutputShape() const {
+    return Worker.GetLastOutputShape();
+}
+
+}  // namespace NTestTracker
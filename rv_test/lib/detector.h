@@ -0,0 +1,171 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+namespace NTestTracker {
+
+// A single object found in a frame, in the coordinates of that frame.
+struct TDetection {
+    cv::Rect Box;
+    float Confidence = 0.0f;
+    int ClassId = -1;
+};
+
+/**
+ * @class TDetectionsView
+ * @brief Non-owning view of the detections found in one frame.
+ *
+ * The view points into the internal buffer of the TDetector that produced it
+ * and stays valid only until the next call to that detector.
+ */
+class TDetectionsView {
+public:
+    TDetectionsView() = default;
+    TDetectionsView(const TDetection* data, size_t size)
+        : Data(data)
+        , Size(size)
+    {}
+
+    [[nodiscard]] const TDetection* begin() const { return Data; }
+    [[nodiscard]] const TDetection* end() const { return Data + Size; }
+    [[nodiscard]] const TDetection& operator[](size_t i) const { return Data[i]; }
+    [[nodiscard]] size_t size() const { return Size; }
+    [[nodiscard]] bool empty() const { return Size == 0; }
+
+private:
+    const TDetection* Data = nullptr;
+    size_t Size = 0;
+};
+
+// Inference settings of TDetector.
+struct TDetectorOptions {
+    float ConfThreshold = 0.25f; // detections below this confidence are dropped
+    int NumClasses = 3; // detections with class id outside [0, NumClasses) are dropped
+    int IntraOpNumThreads = 4; // ONNX Runtime threads used by a single inference call
+};
+
+// Version of the ONNX Runtime library the detector runs on, e.g. "1.17.1".
+[[nodiscard]] std::string GetOnnxRuntimeVersion();
+
+// The loaded model shared by a TDetector and its workers, defined in detector.cpp.
+struct TDetectorModel;
+
+/**
+ * @class TDetectorWorker
+ * @brief The per-thread part of a TDetector: preprocessing, tensor and result buffers.
+ *
+ * Workers created by the same TDetector share its ONNX Runtime session, whose
+ * Run() is thread-safe, so a thread pool needs the model loaded only once.
+ * A single worker must not be used by several threads at the same time.
+ * A worker keeps the model alive and may outlive its TDetector.
+ */
+class TDetectorWorker {
+public:
+    ~TDetectorWorker();
+
+    TDetectorWorker(const TDetectorWorker&) = delete;
+    TDetectorWorker& operator=(const TDetectorWorker&) = delete;
+    TDetectorWorker(TDetectorWorker&&) noexcept;
+    TDetectorWorker& operator=(TDetectorWorker&&) noexcept;
+
+    /**
+     * Detects objects in a BGR frame.
+     *
+     * @return A view of the detections, valid until the next call to this worker.
+     */
+    [[nodiscard]] TDetectionsView Detect(const cv::Mat& frame);
+
+    /**
+     * Detects objects in every frame of a batch.
+     *
+     * @param[out] results Detections per frame. The vector is resized to the batch
+     *                     size, and the capacity of its elements is reused between calls.
+     */
+    void DetectBatch(const std::vector<cv::Mat>& frames, std::vector<std::vector<TDetection>>& results);
+
+    // Shape of the raw model output of the last Detect() call, e.g. [1, 300, 6]; empty before the first call.
+    [[nodiscard]] const std::vector<int64_t>& GetLastOutputShape() const;
+
+private:
+    friend class TDetector;
+    explicit TDetectorWorker(std::shared_ptr<TDetectorModel> model);
+
+    class TImpl;
+    std::unique_ptr<TImpl> Impl;
+};
+
+/**
+ * @class TDetector
+ * @brief Runs the ONNX detection model on single frames, batches or whole videos.
+ *
+ * The model is loaded once in the constructor, and all the preprocessing and
+ * result buffers are reused between calls, so steady-state detection does not
+ * allocate per frame. The detector has no GUI and does not own any video source.
+ *
+ * Detect(), DetectBatch() and DetectStream() use the detector's own buffers and
+ * must be called from one thread at a time. To drive the model from a thread pool,
+ * give every thread its own CreateWorker(): all the workers share the same session.
+ */
+class TDetector {
+public:
+    // Called for every frame of a stream; returning false stops the stream.
+    using TFrameCallback = std::function<bool(size_t frameIndex, const cv::Mat& frame, TDetectionsView detections)>;
+
+    /**
+     * Loads the model and prepares the inference buffers.
+     *
+     * @throws std::invalid_argument if the model file does not exist.
+     */
+    explicit TDetector(const std::string& model, const TDetectorOptions& options = {});
+    ~TDetector();
+
+    TDetector(const TDetector&) = delete;
+    TDetector& operator=(const TDetector&) = delete;
+    TDetector(TDetector&&) noexcept;
+    TDetector& operator=(TDetector&&) noexcept;
+
+    /**
+     * Creates a worker with its own buffers over the shared model session.
+     */
+    [[nodiscard]] TDetectorWorker CreateWorker() const;
+
+    /**
+     * Detects objects in a BGR frame.
+     *
+     * @return A view of the detections, valid until the next call to this detector.
+     */
+    [[nodiscard]] TDetectionsView Detect(const cv::Mat& frame);
+
+    /**
+     * Detects objects in every frame of a batch.
+     *
+     * @param[out] results Detections per frame. The vector is resized to the batch
+     *                     size, and the capacity of its elements is reused between calls.
+     */
+    void DetectBatch(const std::vector<cv::Mat>& frames, std::vector<std::vector<TDetection>>& results);
+
+    /**
+     * Reads frames from the video until it ends or the callback returns false,
+     * and invokes the callback with the detections of every frame.
+     *
+     * @return The number of processed frames.
+     */
+    size_t DetectStream(cv::VideoCapture& video, const TFrameCallback& callback);
+
+    // Shape of the model output as declared by the model; dynamic dimensions are -1.
+    [[nodiscard]] const std::vector<int64_t>& GetOutputShape() const;
+
+    // Shape of the raw model output of the last Detect() call, e.g. [1, 300, 6]; empty before the first call.
+    [[nodiscard]] const std::vector<int64_t>& GetLastOutputShape() const;
+
+private:
+    std::shared_ptr<TDetectorModel> Model;
+    TDetectorWorker Worker; // buffers of the single-threaded calls
+};
+
+}  // namespace NTestTracker
@@ -1,35 +1,29 @@
 #include <opencv2/opencv.hpp>
 #include <opencv2/imgproc.hpp>
-#include <onnxruntime_cxx_api.h>
 #include <iostream>
-#include <filesystem>
 #include <algorithm>
 #include <chrono>
 
+#include "detector.h"
 #include "tracker.h"
 
 namespace NTestTracker {
 
-// Model and Inference Constants
-// The input image size (width and height) required by the ONNX model.
-constexpr size_t IMAGE_SIZE_FOR_ONNX = 640;
-
-// The confidence threshold for filtering detected objects. Detections below this value will be ignored.
-constexpr float CONF_THRESHOLD  = 0.25f;
-
-// The total number of classes the model is trained to detect.
-constexpr int NUM_CLASSES = 3;
-
 // Display Constants
 // Default width for the application's display window.
 constexpr size_t WINDOW_WIDTH_FOR_SHOW = 1280;
 constexpr size_t WINDOW_HEIGHT_FOR_SHOW = 720;
 
+// Sampling Constants
+// If the next frame to process is further away than this, seek to it instead of grabbing every frame in between.
+// With the FFmpeg backend grab() still decodes the frame, so only seeking makes large strides cheap.
+constexpr size_t MAX_FRAMES_TO_GRAB_BEFORE_SEEK = 64;
+
 int TTestTracker::Run() {
     // 1. Initialization and Information Logging
     std::cout << "System Information" << std::endl;
     std::cout << "OpenCV version: " << CV_VERSION << std::endl;
-    std::cout << "ONNX Runtime version: " << OrtGetApiBase()->GetVersionString() << std::endl;
+    std::cout << "ONNX Runtime version: " << GetOnnxRuntimeVersion() << std::endl;
     std::cout << "Video source: " << VideoData << std::endl;
     std::cout << "Model path: " << Model << std::endl;
 
@@ -51,30 +45,16 @@ int TTestTracker::Run() {
     std::cout << "Frame count: " << totalFrames << std::endl;
     std::cout << "Resolution: " << width << "x" << height << std::endl;
 
-    // 3. ONNX Runtime Initialization
-    Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "YOLOv8-Tracker");
-    Ort::SessionOptions session_options;
-    session_options.SetIntraOpNumThreads(4);
-    session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
-
-    // Ensure the model file exists before attempting to load it.
-    if (!std::filesystem::exists(Model)) {
-        std::cerr << "The model was not found: " << Model << std::endl;
+    // 3. Detector Initialization
+    // The detector loads the model once and reuses its inference buffers for every frame.
+    std::optional<TDetector> detector;
+    try {
+        detector.emplace(Model);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
         return -1;
     }
 
-    // Create an inference session from the model file.
-    Ort::Session session = Ort::Session(env, Model.c_str(), session_options);
-
-    // Get the model's input and output layer names dynamically.
-    Ort::AllocatorWithDefaultOptions allocator;
-
-    const auto inputNameAllocated = session.GetInputNameAllocated(0, allocator);
-    const auto outputNameAllocated = session.GetOutputNameAllocated(0, allocator);
-
-    const char* inputName = inputNameAllocated.get();
-    const char* outputName = outputNameAllocated.get();
-
     // 4. Pre-Loop Setup
     cv::namedWindow("Result", cv::WINDOW_NORMAL);
     cv::resizeWindow("Result", WINDOW_WIDTH_FOR_SHOW, WINDOW_HEIGHT_FOR_SHOW);
@@ -86,21 +66,36 @@ int TTestTracker::Run() {
         cv::Scalar(0, 0, 255)     // Red for kites
     };
 
-    // Prepare a buffer for the input tensor.
-    const std::vector<int64_t> inputShape = {1, 3, IMAGE_SIZE_FOR_ONNX, IMAGE_SIZE_FOR_ONNX};
-    const size_t inputTensorSize = 1 * 3 * IMAGE_SIZE_FOR_ONNX * IMAGE_SIZE_FOR_ONNX;
-    std::vector<float> inputTensorValues(inputTensorSize);
-
     // 5. Main Processing Loop
     std::cout << "\nProcessing... (Press ESC to exit, Space to pause)\n" << std::endl;
     const auto startTime = std::chrono::high_resolution_clock::now();
 
+    const size_t frameStride = FrameStride.value_or(1);
+    const size_t startFrame = StartFrame.value_or(0);
+
+    size_t frameIndex = 0; // index of the next source frame to grab
+    if (!SkipToFrame(video, frameIndex, startFrame)) {
+        std::cout << "Error: Video ended before the start frame " << startFrame << "!" << std::endl;
+        return -1;
+    }
+
     cv::Mat frame;
     int frameCount = 0;
+    size_t nextSampledFrame = startFrame;
     bool firstFrame = true;
 
-    while (video.read(frame)) {
-        if (frame.empty()) {
+    while (!EndFrame.has_value() || nextSampledFrame < EndFrame.value()) {
+        // Frames between the samples are grabbed without the conversion into a cv::Mat
+        // done by retrieve(), or skipped by seeking when the stride is large.
+        if (!SkipToFrame(video, frameIndex, nextSampledFrame) || !video.grab()) {
+            std::cout << "End of video stream." << std::endl;
+            break;
+        }
+
+        const size_t currentFrameIndex = frameIndex++;
+        nextSampledFrame += frameStride;
+
+        if (!video.retrieve(frame) || frame.empty()) {
             std::cout << "End of video stream." << std::endl;
             break;
         }
@@ -113,65 +108,11 @@ int TTestTracker::Run() {
             FilterFrame(); // Apply median blur filter if enabled.
             // `filteredFrame` now contains the result of these optional steps.
 
-            // 5.2 Inference Preprocessing (Manual Tensor Preparation)
-            // The model requires a 640x640 RGB image, normalized to [0, 1], in NCHW format.
-            // Resize the frame to the model's required input dimensions.
-            cv::Mat resizedFilteredFrame;
-            cv::resize(filteredFrame, resizedFilteredFrame, cv::Size(IMAGE_SIZE_FOR_ONNX, IMAGE_SIZE_FOR_ONNX));
-
-            // Convert from BGR (OpenCV's default) to RGB, which the model expects.
-            cv::Mat rgbFrame;
-            cv::cvtColor(resizedFilteredFrame, rgbFrame, cv::COLOR_BGR2RGB);
-
-            // Normalize pixel values from the [0, 255] integer range to the [0.0, 1.0] float range.
-            cv::Mat floatRgbFrame;
-            rgbFrame.convertTo(floatRgbFrame, CV_32F, 1.0 / 255.0);
-
-            // Convert the image from HWC (Height, Width, Channels) to NCHW (Batch, Channels, Height, Width) format.
-            std::vector<cv::Mat> channels(3);
-            cv::split(floatRgbFrame, channels);
-
-            for (int c = 0; c < 3; ++c) {
-                if (!channels[c].isContinuous()) {
-                    throw std::runtime_error(
-                        "Channel " + std::to_string(c) + " is not continuous in memory"
-                    );
-                }
-
-                memcpy(
-                    inputTensorValues.data() + c * IMAGE_SIZE_FOR_ONNX * IMAGE_SIZE_FOR_ONNX,
-                    channels[c].data,
-                    IMAGE_SIZE_FOR_ONNX * IMAGE_SIZE_FOR_ONNX * sizeof(float)
-                );
-             }
-
-            // 5.3 Create ONNX Tensor and Run Inference
-            auto memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-            Ort::Value inputTensor = Ort::Value::CreateTensor<float>(
-                memoryInfo,
-                inputTensorValues.data(),
-                inputTensorSize,
-                inputShape.data(),
-                inputShape.size()
-            );
-
-            std::vector<const char*> inputNamesVec = {inputName};
-            std::vector<const char*> outputNamesVec = {outputName};
-
-            auto outputTensors = session.Run(
-                Ort::RunOptions{nullptr},
-                inputNamesVec.data(),
-                &inputTensor,
-                1,
-                outputNamesVec.data(),
-                1
-            );
-
-            // 5.4 Post-processing (Parse and Draw Detections)
-            float* outputData = outputTensors[0].GetTensorMutableData<float>();
-            auto outputShape = outputTensors[0].GetTensorTypeAndShapeInfo().GetShape();
+            // 5.2 Inference
+            const TDetectionsView detections = detector->Detect(filteredFrame);
 
             if (firstFrame) {
+                const std::vector<int64_t>& outputShape = detector->GetLastOutputShape();
                 std::cout << "Model Output Shape: [";
                 for (size_t i = 0; i < outputShape.size(); ++i) {
                     std::cout << outputShape[i];
@@ -183,47 +124,16 @@ int TTestTracker::Run() {
                 firstFrame = false;
             }
 
-            int numDetections = outputShape[1];  // 300
-            int detectionSize = outputShape[2];  // 6
-
-            // Calculate scaling factors to map detections from the model's input size (640x640) back to the original frame size.
-            const float xScale = static_cast<float>(frame.cols) / IMAGE_SIZE_FOR_ONNX;
-            const float yScale = static_cast<float>(frame.rows) / IMAGE_SIZE_FOR_ONNX;
-
+            // 5.3 Draw Detections
             // Draw on a copy of the pristine, original frame.
             cv::Mat resultFrame = frame.clone();
             int validDetections = 0;
             int textThickness = 1;
 
-            // The model output is expected to be already post-processed with NMS.
-            // The format is [x_left, y_top, x_right, y_bottom, confidence, class_id] for each detection
-            for (int i = 0; i < numDetections; ++i) {
-                const int baseIdx = i * detectionSize;
-                const float confidence = outputData[baseIdx + 4];
-                const int classId = static_cast<int>(outputData[baseIdx + 5]);
-
-                // Filter out low-confidence detections and invalid classes.
-                if (confidence < CONF_THRESHOLD || classId < 0 || classId >= NUM_CLASSES) {
-                    continue;
-                }
-
-                // Scale bounding box coordinates to the original frame's dimensions.
-                int left = static_cast<int>(outputData[baseIdx + 0] * xScale);
-                int top = static_cast<int>(outputData[baseIdx + 1] * yScale);
-                int right = static_cast<int>(outputData[baseIdx + 2] * xScale);
-                int bottom = static_cast<int>(outputData[baseIdx + 3] * yScale);
-
-                // Clamp coordinates to be within frame boundaries to prevent drawing errors.
-                left = std::max(0, std::min(left, frame.cols - 1));
-                top = std::max(0, std::min(top, frame.rows - 1));
-                right = std::max(0, std::min(right, frame.cols));
-                bottom = std::max(0, std::min(bottom, frame.rows));
-
-                if (right <= left || bottom <= top) {
-                    continue; // Skip invalid boxes with zero or negative area.
-                }
-
-                cv::Rect box(left, top, right - left, bottom - top);
+            for (const TDetection& detection : detections) {
+                const cv::Rect& box = detection.Box;
+                const float confidence = detection.Confidence;
+                const int classId = detection.ClassId;
                 validDetections++;
 
                 // Draw the bounding box.
@@ -238,7 +148,7 @@ int TTestTracker::Run() {
                 // Define text properties
                 int fontFace = cv::FONT_HERSHEY_SIMPLEX;
                 double fontScale = 0.7;
-                cv::Point text_origin(left, top - 10); // Position just above the bounding box
+                cv::Point text_origin(box.x, box.y - 10); // Position just above the bounding box
 
                 // Draw a dark outline ("shadow") for the text first
                 cv::putText(
@@ -265,17 +175,18 @@ int TTestTracker::Run() {
                 );
             }
 
-            // 5.5 Logging and Display
+            // 5.4 Logging and Display
             if (frameCount % 30 == 0) {
                 auto now = std::chrono::high_resolution_clock::now();
                 auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - startTime).count();
-                std::cout << "Frame " << frameCount << "/" << totalFrames
+                std::cout << "Frame " << currentFrameIndex << "/" << totalFrames
+                          << " | Sampled frames: " << frameCount
                           << " | Time elapsed: " << elapsed << "s | Detections in frame: " << validDetections << std::endl;
             }
 
             // Draw overlay information on the frame for visual feedback.
-            std::string frameInfo = cv::format("Frame: %d/%d | Detections: %d",
-                frameCount, totalFrames, validDetections);
+            std::string frameInfo = cv::format("Frame: %zu/%d | Detections: %d",
+                currentFrameIndex, totalFrames, validDetections);
 
             cv::putText(resultFrame, frameInfo, cv::Point(10, 30),
                        cv::FONT_HERSHEY_SIMPLEX, 0.7,
@@ -307,10 +218,48 @@ int TTestTracker::Run() {
     cv::destroyAllWindows();
 
     std::cout << "\nTotal frames processed: " << frameCount << std::endl;
+    if (frameStride > 1) {
+        std::cout << "Frame stride: " << frameStride << std::endl;
+    }
 
     return 0;
 };
 
+bool TTestTracker::SkipToFrame(cv::VideoCapture& video, size_t& position, const size_t targetFrame) const {
+    if (position >= targetFrame) {
+        return true;
+    }
+
+    // Seeking makes the backend jump to the nearest keyframe and decode forward from it,
+    // which is much cheaper than grabbing every frame in between.
+    if (targetFrame - position > MAX_FRAMES_TO_GRAB_BEFORE_SEEK
+        && video.set(cv::CAP_PROP_POS_FRAMES, static_cast<double>(targetFrame)))
+    {
+        // The seek may be inexact, so continue from wherever the backend ended up.
+        position = static_cast<size_t>(std::max(0.0, video.get(cv::CAP_PROP_POS_FRAMES)));
+        if (position > targetFrame) {
+            // Start over and grab frames one by one; without the reset the index wouldn't match the stream.
+            if (!video.set(cv::CAP_PROP_POS_FRAMES, 0)) {
+                return false;
+            }
+
+            position = static_cast<size_t>(std::max(0.0, video.get(cv::CAP_PROP_POS_FRAMES)));
+            if (position > targetFrame) {
+                return false;
+            }
+        }
+    }
+
+    // Seeking is not supported by the source (or the target is close), so grab the frames in between.
+    for (; position < targetFrame; ++position) {
+        if (!video.grab()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 void TTestTracker::AverageFrames(const cv::Mat& currentFrame) {
     if (currentFrame.empty()) {
         throw std::runtime_error("Cannot average an empty frame.");
@@ -20,19 +20,39 @@ class TTestTracker {
 public:
     /**
      * Constructs a TTestTracker object with specified configurations.
-     */    TTestTracker(
+     *
+     * The optional sampling parameters restrict processing to the source frames
+     * [startFrame, endFrame) and take every frameStride-th frame of that range.
+     * Short gaps between the sampled frames are grabbed without retrieving them,
+     * longer ones are skipped by seeking.
+     */
+    TTestTracker(
         const std::string& videoData,
         const std::string& model,
         const std::optional<size_t> aveListSize = std::nullopt,
-        const std::optional<size_t> medianFilterWindowSize = std::nullopt)
+        const std::optional<size_t> medianFilterWindowSize = std::nullopt,
+        const std::optional<size_t> frameStride = std::nullopt,
+        const std::optional<size_t> startFrame = std::nullopt,
+        const std::optional<size_t> endFrame = std::nullopt)
         : VideoData(videoData)
         , Model(model)
         , AveragingListSize(aveListSize)
         , MedianFilterWindowSize(medianFilterWindowSize)
+        , FrameStride(frameStride)
+        , StartFrame(startFrame)
+        , EndFrame(endFrame)
     {
         if (VideoData.empty() || Model.empty()) {
             throw std::invalid_argument("VideoData and Model cannot be empty");
         }
+
+        if (FrameStride.has_value() && FrameStride.value() == 0) {
+            throw std::invalid_argument("FrameStride must be greater than zero");
+        }
+
+        if (EndFrame.has_value() && EndFrame.value() <= StartFrame.value_or(0)) {
+            throw std::invalid_argument("EndFrame must be greater than StartFrame");
+        }
     }
 
     /**
@@ -45,9 +65,17 @@ public:
     [[nodiscard]] int Run();
 
 protected:
+    // Positions the video so that the next grab() returns the source frame targetFrame.
+    // position is the index of the next frame to grab and is updated. Seeks when the target
+    // is far away and grabs the few frames in between otherwise.
+    // Returns false if the video ends before targetFrame or can't be repositioned.
+    bool SkipToFrame(cv::VideoCapture& video, size_t& position, const size_t targetFrame) const;
+
     // Frame Preprocessing Methods
     // Maintains running average of frames using circular buffer
     // This filter is effective against Gaussian noise.
+    // With a frame stride the window is counted in sampled frames, so it spans
+    // AveragingListSize * FrameStride source frames.
     void AverageFrames(const cv::Mat& currentFrame);
 
     // Applies median filter to averaged frame using specified window size
@@ -62,6 +90,11 @@ private:
     const std::optional<size_t> AveragingListSize {std::nullopt}; // number of frames to average
     const std::optional<size_t> MedianFilterWindowSize {std::nullopt};
 
+    // Optional sampling parameters
+    const std::optional<size_t> FrameStride {std::nullopt}; // process every N-th frame
+    const std::optional<size_t> StartFrame {std::nullopt}; // first source frame to process
+    const std::optional<size_t> EndFrame {std::nullopt}; // source frame to stop at (exclusive)
+
     // Frame processing buffers
     std::deque<cv::Mat> FrameListForPreprocessing; // list of frames to average
     cv::Mat sumFrame; // CV_32F
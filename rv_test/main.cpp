@@ -20,6 +20,9 @@ using namespace NTestTracker;
  * @param[out] modelPath Reference to a string that will store the path to the model file.
  * @param[out] averageWindowSize Optional reference to store the frame averaging window size.
  * @param[out] medianWindowSize Optional reference to store the median filter window size.
+ * @param[out] frameStride Optional reference to store the frame sampling stride.
+ * @param[out] startFrame Optional reference to store the first frame of the processed range.
+ * @param[out] endFrame Optional reference to store the end (exclusive) of the processed range.
  * @return int Returns 0 on successful parsing, and a non-zero value on error or if help is displayed.
  */
 int InitProgramParams(
@@ -28,7 +31,10 @@ int InitProgramParams(
     std::string& videoPath,
     std::string& modelPath,
     std::optional<size_t>& averageWindowSize,
-    std::optional<size_t>& medianWindowSize)
+    std::optional<size_t>& medianWindowSize,
+    std::optional<size_t>& frameStride,
+    std::optional<size_t>& startFrame,
+    std::optional<size_t>& endFrame)
 {
     char* video_file = nullptr;
     char* model_file = nullptr;
@@ -37,6 +43,9 @@ int InitProgramParams(
         {"model", required_argument, nullptr, 'm'},
         {"frame_averaging_window", required_argument, nullptr, 'w'},
         {"median_window", required_argument, nullptr, 'k'},
+        {"stride", required_argument, nullptr, 's'},
+        {"start", required_argument, nullptr, 'b'},
+        {"end", required_argument, nullptr, 'e'},
         {"help", no_argument, nullptr, 'h'},
         {nullptr, no_argument, nullptr, 0}
     };
@@ -45,7 +54,7 @@ int InitProgramParams(
     int option_index = 0;
 
     // This string defines the short options. A colon (:) after a character means it requires an argument.
-    const static char options[] = "v:m:w:k:h";
+    const static char options[] = "v:m:w:k:s:b:e:h";
     while ((opt = getopt_long(argc, argv, options, long_options, &option_index)) != -1) {
         switch (opt) {
             case 'v':
@@ -72,6 +81,38 @@ int InitProgramParams(
                 }
 
 
+                break;
+            case 's':
+                try {
+                    frameStride = std::make_optional<size_t>(std::stoul(optarg));
+                } catch (...) {
+                    std::cerr << "Invalid number for --stride: " << optarg << "\n";
+                    return 1;
+                }
+
+                if (frameStride.value() == 0) {
+                    std::cerr << "--stride must be greater than zero.\n";
+                    return 1;
+                }
+
+                break;
+            case 'b':
+                try {
+                    startFrame = std::make_optional<size_t>(std::stoul(optarg));
+                } catch (...) {
+                    std::cerr << "Invalid number for --start: " << optarg << "\n";
+                    return 1;
+                }
+
+                break;
+            case 'e':
+                try {
+                    endFrame = std::make_optional<size_t>(std::stoul(optarg));
+                } catch (...) {
+                    std::cerr << "Invalid number for --end: " << optarg << "\n";
+                    return 1;
+                }
+
                 break;
             case 'h':
                 std::cout << "Usage: " << argv[0] << " [OPTIONS]\n\n";
@@ -81,6 +122,9 @@ int InitProgramParams(
                 std::cout << "Optional arguments:\n";
                 std::cout << "  -w, --frame_averaging_window N      Number of frames for the moving average filter.\n";
                 std::cout << "  -k, --median_window N               Kernel size for the median filter (must be an odd number > 1).\n";
+                std::cout << "  -s, --stride N                      Process every N-th frame; skipped frames are grabbed without retrieve(), gaps over 64 frames are skipped by seeking.\n";
+                std::cout << "  -b, --start N                       Index of the first frame to process (default 0).\n";
+                std::cout << "  -e, --end N                         Index of the frame to stop at, exclusive (default: end of video).\n";
                 std::cout << "  -h, --help                          Show this help message and exit.\n";
                 return 1; // Return 1 to indicate that the program should exit.
             default: // Handles unknown options
@@ -106,6 +150,11 @@ int InitProgramParams(
         modelPath = model_file;
     }
 
+    if (endFrame.has_value() && endFrame.value() <= startFrame.value_or(0)) {
+        std::cerr << "Error: --end must be greater than --start.\n";
+        return 1;
+    }
+
     return 0; // Success
 }
 
@@ -119,6 +168,9 @@ int InitProgramParams(
     std::optional<size_t> averageWindowSize;
     std::optional<size_t> medianWindowSize;
     std::optional<size_t> bilateralWindowSize;
+    std::optional<size_t> frameStride;
+    std::optional<size_t> startFrame;
+    std::optional<size_t> endFrame;
 
     // Parse command-line arguments.
     if (InitProgramParams(
@@ -127,9 +179,19 @@ int InitProgramParams(
         videoPath,
         modelPath,
         averageWindowSize,
-        medianWindowSize) == 0)
+        medianWindowSize,
+        frameStride,
+        startFrame,
+        endFrame) == 0)
     {
-        TTestTracker trackerJob(videoPath, modelPath, averageWindowSize, medianWindowSize);
+        TTestTracker trackerJob(
+            videoPath,
+            modelPath,
+            averageWindowSize,
+            medianWindowSize,
+            frameStride,
+            startFrame,
+            endFrame);
         return trackerJob.Run();
     }
 